@@ -0,0 +1,75 @@
+#pragma once
+
+#include "hash_table.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+namespace core::cache
+{
+
+/**
+ * How often a cache had what it was asked for, and how many entries it had to
+ * evict to make room.
+ */
+struct CacheStats
+{
+  size_t hits;
+  size_t misses;
+  size_t evictions;
+
+  float hit_ratio() const
+  {
+    const auto lookups = this->hits + this->misses;
+    return lookups ? (float)this->hits / (float)lookups : 0;
+  }
+};
+
+namespace internal
+{
+
+/// Marks the absence of a slot, such as the neighbour of a list's ends.
+inline constexpr uint32_t no_slot = std::numeric_limits<uint32_t>::max();
+
+/**
+ * The caches' index from keys to the slots holding their entries.
+ */
+template <typename K, typename H>
+using SlotIndex = hash_table::OAHashTable<uint32_t, K, H>;
+
+/**
+ * How many rows a cache's index starts with. A full cache keeps at most 3/8
+ * of them taken, so that evictions' tombstones are purged in place rather
+ * than growing the index.
+ */
+inline size_t index_capacity_for(size_t capacity)
+{
+  return capacity * 8 / 3 + 1;
+}
+
+inline void validate_capacity(size_t capacity) noexcept(false)
+{
+  if (capacity == 0 || capacity >= no_slot)
+  {
+    throw std::invalid_argument("A cache must hold between 1 and 2^32 - 2 "
+                                "entries");
+  }
+}
+
+/**
+ * How many entries fit in `bytes`, counting each slot and its index rows.
+ */
+template <typename Slot, typename K, typename H>
+size_t capacity_for_bytes(size_t bytes)
+{
+  const auto entry_size = sizeof(Slot) + SlotIndex<K, H>::row_size * 8 / 3;
+  return bytes / entry_size;
+}
+
+} // namespace internal
+
+} // namespace core::cache
+
+#include "cache/clock.hpp"
+#include "cache/lru.hpp"
@@ -0,0 +1,211 @@
+#pragma once
+
+#include "cache.hpp"
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace core::cache
+{
+
+/**
+ * A cache of at most `capacity` entries that approximates `LRUCache`'s
+ * evictions with the CLOCK algorithm.
+ *
+ * A hit only sets its entry's reference bit, instead of relinking it as an
+ * LRU list does, which makes hits cheaper and keeps them from writing to any
+ * other entry. To evict, a hand sweeps the slots in a circle, clearing the
+ * bits it passes by, and evicts the first entry not referenced since the
+ * hand's last pass. New entries start unreferenced, so keys used once are
+ * evicted before keys used repeatedly.
+ *
+ * Slots and their index are laid out as `LRUCache`'s are.
+ */
+template <typename V, typename K = size_t,
+          typename H = hash_table::Hash<K>>
+class ClockCache
+{
+private:
+  struct Slot
+  {
+    std::optional<std::pair<K, V>> entry;
+    bool referenced;
+  };
+
+  std::vector<Slot> slots;
+  /// Slots of removed entries, which are filled before any other.
+  std::vector<uint32_t> free_slots;
+  internal::SlotIndex<K, H> index;
+  size_t _capacity;
+  uint32_t hand;
+  CacheStats _stats;
+
+  /**
+   * Sweeps the hand on to the next unreferenced entry, and past it.
+   * Everything is unreferenced after at most one whole turn, so it always
+   * returns as long as the cache isn't empty.
+   *
+   * @returns The slot of the entry to evict.
+   */
+  uint32_t sweep()
+  {
+    while (true)
+    {
+      const auto slot = this->hand;
+      Slot &current = this->slots[slot];
+      this->hand = slot + 1 == this->slots.size() ? 0 : slot + 1;
+
+      if (!current.entry) continue;
+      if (!current.referenced) return slot;
+      current.referenced = false;
+    }
+  }
+
+  template <typename Q> V *find_key(const Q &key)
+  {
+    const uint32_t *slot = this->index.find(key);
+    if (!slot)
+    {
+      this->_stats.misses++;
+      return nullptr;
+    }
+
+    this->_stats.hits++;
+    Slot &hit = this->slots[*slot];
+    // skips the store when it's already set, to keep the line clean.
+    if (!hit.referenced) hit.referenced = true;
+    return &hit.entry->second;
+  }
+
+public:
+  /**
+   * @param capacity How many entries the cache holds at most, between 1 and
+   * 2^32 - 2.
+   */
+  ClockCache(size_t capacity) noexcept(false)
+      : index(internal::index_capacity_for(capacity)), _capacity(capacity),
+        hand(0), _stats{0, 0, 0}
+  {
+    internal::validate_capacity(capacity);
+    this->slots.reserve(capacity);
+  }
+
+  /**
+   * Builds a cache holding as many entries as fit in `bytes`. Only the
+   * entries themselves are counted, not any memory their keys or values own.
+   */
+  static ClockCache with_memory_budget(size_t bytes) noexcept(false)
+  {
+    return ClockCache(internal::capacity_for_bytes<Slot, K, H>(bytes));
+  }
+
+  size_t size() const { return this->index.size(); }
+  size_t capacity() const { return this->_capacity; }
+  CacheStats stats() const { return this->_stats; }
+
+  /**
+   * Looks `key` up, marking its entry as referenced.
+   *
+   * @returns A pointer to the key's value, that is valid until the entry is
+   * evicted or removed, or `nullptr` if the key is not cached.
+   */
+  V *find(const K &key) { return this->find_key(key); }
+
+  /**
+   * Looks up a key equal to `key` without building a `K` from it.
+   */
+  template <typename Q>
+    requires hash_table::internal::HeterogeneousKey<Q, K, H>
+  V *find(const Q &key)
+  {
+    return this->find_key(key);
+  }
+
+  std::optional<V> get(const K &key)
+  {
+    const V *value = this->find(key);
+    if (!value) return std::nullopt;
+    return *value;
+  }
+
+  /**
+   * Whether `key` is cached, without counting as a use of it.
+   */
+  bool contains(const K &key) const { return this->index.find(key); }
+
+  /**
+   * Caches `value` for `key`, or replaces its current value, marking it as
+   * referenced. Evicts an entry as the hand dictates if the cache is full.
+   */
+  void put(K key, V value) noexcept(false)
+  {
+    if (const uint32_t *slot = this->index.find(key))
+    {
+      this->slots[*slot].entry->second = std::move(value);
+      this->slots[*slot].referenced = true;
+      return;
+    }
+
+    uint32_t slot;
+    if (!this->free_slots.empty())
+    {
+      slot = this->free_slots.back();
+      this->free_slots.pop_back();
+    }
+    else if (this->slots.size() < this->_capacity)
+    {
+      slot = (uint32_t)this->slots.size();
+      this->slots.emplace_back();
+    }
+    else
+    {
+      slot = this->sweep();
+      this->index.remove(std::move(this->slots[slot].entry->first));
+      this->_stats.evictions++;
+    }
+
+    this->slots[slot].entry.emplace(std::move(key), std::move(value));
+    this->slots[slot].referenced = false;
+    this->index.try_emplace(this->slots[slot].entry->first, slot);
+  }
+
+  /**
+   * Evicts the entry the hand stops at.
+   *
+   * @returns The evicted entry, or `nullopt` if the cache is empty.
+   */
+  std::optional<std::pair<K, V>> evict()
+  {
+    if (this->size() == 0) return std::nullopt;
+
+    const auto slot = this->sweep();
+    auto entry = std::move(this->slots[slot].entry);
+    this->slots[slot].entry.reset();
+    this->index.remove(entry->first);
+    this->free_slots.push_back(slot);
+    this->_stats.evictions++;
+
+    return entry;
+  }
+
+  /**
+   * Drops `key`'s entry, if cached. It doesn't count as an eviction.
+   *
+   * @returns Whether the key was cached.
+   */
+  bool remove(K key)
+  {
+    const uint32_t *found = this->index.find(key);
+    if (!found) return false;
+
+    const auto slot = *found;
+    this->index.remove(std::move(key));
+    this->slots[slot].entry.reset();
+    this->free_slots.push_back(slot);
+
+    return true;
+  }
+};
+
+} // namespace core::cache
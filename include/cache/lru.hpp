@@ -0,0 +1,239 @@
+#pragma once
+
+#include "cache.hpp"
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace core::cache
+{
+
+/**
+ * A cache of at most `capacity` entries, that evicts the least recently used
+ * one to make room for a new one.
+ *
+ * Entries live in a fixed array of slots, linked from the most to the least
+ * recently used by their indices, and an `OAHashTable` maps keys to their
+ * slots. Evicted entries' slots are reused in place, so a full cache doesn't
+ * allocate, but keys are stored both in their slot and in the index.
+ */
+template <typename V, typename K = size_t,
+          typename H = hash_table::Hash<K>>
+class LRUCache
+{
+private:
+  struct Slot
+  {
+    std::optional<std::pair<K, V>> entry;
+    uint32_t previous;
+    uint32_t next;
+  };
+
+  std::vector<Slot> slots;
+  /// Slots of removed entries, which are filled before any other.
+  std::vector<uint32_t> free_slots;
+  internal::SlotIndex<K, H> index;
+  size_t _capacity;
+  /// The most and the least recently used slots.
+  uint32_t head;
+  uint32_t tail;
+  CacheStats _stats;
+
+  void unlink(uint32_t slot)
+  {
+    const Slot &node = this->slots[slot];
+
+    if (node.previous != internal::no_slot)
+    {
+      this->slots[node.previous].next = node.next;
+    }
+    else
+    {
+      this->head = node.next;
+    }
+
+    if (node.next != internal::no_slot)
+    {
+      this->slots[node.next].previous = node.previous;
+    }
+    else
+    {
+      this->tail = node.previous;
+    }
+  }
+
+  void link_front(uint32_t slot)
+  {
+    Slot &node = this->slots[slot];
+    node.previous = internal::no_slot;
+    node.next = this->head;
+
+    if (this->head != internal::no_slot)
+    {
+      this->slots[this->head].previous = slot;
+    }
+    else
+    {
+      this->tail = slot;
+    }
+    this->head = slot;
+  }
+
+  template <typename Q> V *find_key(const Q &key)
+  {
+    const uint32_t *slot = this->index.find(key);
+    if (!slot)
+    {
+      this->_stats.misses++;
+      return nullptr;
+    }
+
+    this->_stats.hits++;
+    if (*slot != this->head)
+    {
+      this->unlink(*slot);
+      this->link_front(*slot);
+    }
+    return &this->slots[*slot].entry->second;
+  }
+
+public:
+  /**
+   * @param capacity How many entries the cache holds at most, between 1 and
+   * 2^32 - 2.
+   */
+  LRUCache(size_t capacity) noexcept(false)
+      : index(internal::index_capacity_for(capacity)), _capacity(capacity),
+        head(internal::no_slot), tail(internal::no_slot), _stats{0, 0, 0}
+  {
+    internal::validate_capacity(capacity);
+    this->slots.reserve(capacity);
+  }
+
+  /**
+   * Builds a cache holding as many entries as fit in `bytes`. Only the
+   * entries themselves are counted, not any memory their keys or values own.
+   */
+  static LRUCache with_memory_budget(size_t bytes) noexcept(false)
+  {
+    return LRUCache(internal::capacity_for_bytes<Slot, K, H>(bytes));
+  }
+
+  size_t size() const { return this->index.size(); }
+  size_t capacity() const { return this->_capacity; }
+  CacheStats stats() const { return this->_stats; }
+
+  /**
+   * Looks `key` up, making it the most recently used entry.
+   *
+   * @returns A pointer to the key's value, that is valid until the entry is
+   * evicted or removed, or `nullptr` if the key is not cached.
+   */
+  V *find(const K &key) { return this->find_key(key); }
+
+  /**
+   * Looks up a key equal to `key` without building a `K` from it.
+   */
+  template <typename Q>
+    requires hash_table::internal::HeterogeneousKey<Q, K, H>
+  V *find(const Q &key)
+  {
+    return this->find_key(key);
+  }
+
+  std::optional<V> get(const K &key)
+  {
+    const V *value = this->find(key);
+    if (!value) return std::nullopt;
+    return *value;
+  }
+
+  /**
+   * Whether `key` is cached, without counting as a use of it.
+   */
+  bool contains(const K &key) const { return this->index.find(key); }
+
+  /**
+   * Caches `value` for `key`, or replaces its current value, making it the
+   * most recently used entry. Evicts the least recently used entry if the
+   * cache is full.
+   */
+  void put(K key, V value) noexcept(false)
+  {
+    if (const uint32_t *slot = this->index.find(key))
+    {
+      this->slots[*slot].entry->second = std::move(value);
+      if (*slot != this->head)
+      {
+        this->unlink(*slot);
+        this->link_front(*slot);
+      }
+      return;
+    }
+
+    uint32_t slot;
+    if (!this->free_slots.empty())
+    {
+      slot = this->free_slots.back();
+      this->free_slots.pop_back();
+    }
+    else if (this->slots.size() < this->_capacity)
+    {
+      slot = (uint32_t)this->slots.size();
+      this->slots.emplace_back();
+    }
+    else
+    {
+      slot = this->tail;
+      this->unlink(slot);
+      this->index.remove(std::move(this->slots[slot].entry->first));
+      this->_stats.evictions++;
+    }
+
+    this->slots[slot].entry.emplace(std::move(key), std::move(value));
+    this->index.try_emplace(this->slots[slot].entry->first, slot);
+    this->link_front(slot);
+  }
+
+  /**
+   * Evicts the least recently used entry.
+   *
+   * @returns The evicted entry, or `nullopt` if the cache is empty.
+   */
+  std::optional<std::pair<K, V>> evict()
+  {
+    if (this->tail == internal::no_slot) return std::nullopt;
+
+    const auto slot = this->tail;
+    this->unlink(slot);
+    auto entry = std::move(this->slots[slot].entry);
+    this->slots[slot].entry.reset();
+    this->index.remove(entry->first);
+    this->free_slots.push_back(slot);
+    this->_stats.evictions++;
+
+    return entry;
+  }
+
+  /**
+   * Drops `key`'s entry, if cached. It doesn't count as an eviction.
+   *
+   * @returns Whether the key was cached.
+   */
+  bool remove(K key)
+  {
+    const uint32_t *found = this->index.find(key);
+    if (!found) return false;
+
+    const auto slot = *found;
+    this->index.remove(std::move(key));
+    this->unlink(slot);
+    this->slots[slot].entry.reset();
+    this->free_slots.push_back(slot);
+
+    return true;
+  }
+};
+
+} // namespace core::cache
@@ -1,10 +1,200 @@
 #pragma once
 
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <functional>
 #include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 
 namespace core::hash_table
 {
 
+/**
+ * The default hasher of the hash tables. Integral keys are their own hashes,
+ * any other key is hashed by `std::hash`.
+ */
+template <typename K> struct Hash
+{
+  size_t operator()(const K &key) const
+  {
+    if constexpr (std::is_integral_v<K> || std::is_enum_v<K>)
+    {
+      return static_cast<size_t>(key);
+    }
+    else
+    {
+      return std::hash<K>{}(key);
+    }
+  }
+};
+
+/**
+ * Hashes strings by their content, so that tables keyed by `std::string` can
+ * be searched with `std::string_view`s or C strings without building a
+ * temporary `std::string`.
+ */
+template <> struct Hash<std::string>
+{
+  using is_transparent = void;
+
+  size_t operator()(std::string_view key) const
+  {
+    return std::hash<std::string_view>{}(key);
+  }
+};
+
+namespace internal
+{
+
+/**
+ * The state of an open addressing table's row.
+ */
+enum class State : uint8_t
+{
+  Free,
+  Occupied,
+  Deleted,
+};
+
+/**
+ * Spreads every bit of `hash` over the whole result (SplitMix64's finalizer),
+ * since the hasher may be the identity.
+ */
+inline uint64_t mix(uint64_t hash)
+{
+  hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+  hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+  return hash ^ (hash >> 31);
+}
+
+/**
+ * Whether a table keyed by `K` and hashed by `H` can be searched with a `Q`
+ * other than `K`, which is only allowed if `H` is transparent.
+ */
+template <typename Q, typename K, typename H>
+concept HeterogeneousKey =
+    requires { typename H::is_transparent; } &&
+    requires(const Q &query, const K &key, const H &hasher) {
+      { hasher(query) } -> std::convertible_to<size_t>;
+      { key == query } -> std::convertible_to<bool>;
+    };
+
+} // namespace internal
+
+/**
+ * A snapshot of how well a hash table's keys are spread, as reported by the
+ * tables' `stats()`.
+ *
+ * A key's probe length is how many rows — or chain nodes — a successful
+ * lookup of it reads.
+ */
+struct HashTableStats
+{
+  size_t size;
+  /// The rows, or buckets, count.
+  size_t capacity;
+  float load_factor;
+  /// The share of rows that are tombstones left by removals.
+  float tombstone_ratio;
+  size_t longest_probe;
+  float mean_probe;
+  /// How many keys have each probe length, indexed by the length.
+  std::vector<size_t> probe_histogram;
+  /// The longest run of non-free rows, or the longest chain.
+  size_t longest_cluster;
+  size_t resize_count;
+  std::chrono::nanoseconds resize_duration;
+  /// How many times tombstones were purged in place, without resizing.
+  size_t purge_count;
+  /// How many lookups, insertions and removals were performed, and how many
+  /// rows or nodes they've read in total. Only counted if
+  /// `CORE_HASH_TABLE_PROBE_COUNTERS` is defined, otherwise always zero.
+  size_t operations;
+  size_t operations_probes;
+};
+
+namespace internal
+{
+
+/**
+ * Counts operations and the probes they make. Unless
+ * `CORE_HASH_TABLE_PROBE_COUNTERS` is defined, it holds nothing and counting
+ * compiles to nothing.
+ */
+struct ProbeCounters
+{
+#ifdef CORE_HASH_TABLE_PROBE_COUNTERS
+  size_t operations = 0;
+  size_t probes = 0;
+
+  void count(size_t probes)
+  {
+    this->operations++;
+    this->probes += probes;
+  }
+#else
+  void count(size_t) {}
+#endif
+
+  void report(HashTableStats &stats) const
+  {
+#ifdef CORE_HASH_TABLE_PROBE_COUNTERS
+    stats.operations = this->operations;
+    stats.operations_probes = this->probes;
+#else
+    stats.operations = 0;
+    stats.operations_probes = 0;
+#endif
+  }
+};
+
+/**
+ * Fills the probe length fields of `stats` from its histogram.
+ */
+inline void summarize_probes(HashTableStats &stats)
+{
+  size_t keys = 0;
+  size_t probes = 0;
+  stats.longest_probe = 0;
+
+  for (size_t length = 0; length < stats.probe_histogram.size(); length++)
+  {
+    const auto count = stats.probe_histogram[length];
+    if (count) stats.longest_probe = length;
+    keys += count;
+    probes += count * length;
+  }
+
+  stats.mean_probe = keys ? (float)probes / (float)keys : 0;
+}
+
+/**
+ * Measures how long the enclosing scope takes, adding it to `duration`.
+ */
+class ScopedTimer
+{
+private:
+  std::chrono::nanoseconds &duration;
+  std::chrono::steady_clock::time_point start;
+
+public:
+  ScopedTimer(std::chrono::nanoseconds &duration)
+      : duration(duration), start(std::chrono::steady_clock::now())
+  {
+  }
+
+  ~ScopedTimer()
+  {
+    this->duration += std::chrono::steady_clock::now() - this->start;
+  }
+};
+
+} // namespace internal
+
 template <typename V, typename K> class HashTable
 {
   virtual size_t size() const = 0;
@@ -15,5 +205,12 @@ template <typename V, typename K> class HashTable
 
 } // namespace core::hash_table
 
+#include "hash_table/bloom_filter.hpp"
+#include "hash_table/concurrent.hpp"
+#include "hash_table/cuckoo.hpp"
+#include "hash_table/dense.hpp"
+#include "hash_table/filtered.hpp"
+#include "hash_table/frozen.hpp"
 #include "hash_table/open_addressing.hpp"
 #include "hash_table/separate_chaining.hpp"
+#include "hash_table/snapshot.hpp"
@@ -0,0 +1,375 @@
+#pragma once
+
+#include "hash_table.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace core::hash_table
+{
+
+/**
+ * A hash table that may be shared between threads.
+ *
+ * Keys are spread across independent shards, each one being a linear probing
+ * table guarded by a writers mutex and a sequence lock. Writers of different
+ * shards never contend, and readers never lock at all: they optimistically
+ * probe the shard and retry if a writer has touched it in the meantime.
+ *
+ * Since readers may copy a slot while it is being written, both `K` and `V`
+ * must be trivially copyable, and slots are only accessed through relaxed
+ * atomics: `std::atomic_ref`s of the whole field if those are lock free, of
+ * each of its bytes otherwise.
+ */
+template <typename V, typename K = size_t, typename H = Hash<K>>
+class ConcurrentHashTable : public HashTable<V, K>
+{
+  static_assert(std::is_trivially_copyable_v<K> &&
+                    std::is_trivially_copyable_v<V>,
+                "Optimistic readers require trivially copyable keys and "
+                "values.");
+
+private:
+  struct Slot
+  {
+    alignas(std::atomic_ref<K>::required_alignment) K key;
+    alignas(std::atomic_ref<V>::required_alignment) V value;
+    bool occupied;
+  };
+
+  struct Table
+  {
+    size_t capacity;
+    /// How far hashes are shifted for their home slot to be taken from the
+    /// bits right below the shard's ones.
+    int shift;
+    std::unique_ptr<Slot[]> slots;
+
+    Table(size_t capacity, int shard_bits)
+        : capacity(capacity),
+          shift(64 - shard_bits - std::countr_zero(capacity)),
+          slots(std::make_unique<Slot[]>(capacity))
+    {
+    }
+
+    size_t home_of(size_t hash) const
+    {
+      return (hash >> this->shift) & (this->capacity - 1);
+    }
+  };
+
+  struct alignas(64) Shard
+  {
+    std::mutex writers_mutex;
+    /// Odd while a writer is modifying the shard.
+    std::atomic<size_t> sequence;
+    std::atomic<Table *> table;
+    std::atomic<size_t> size;
+    /// The current table and every table it has replaced. Readers may still
+    /// be probing a replaced table, thus they're only freed along with the
+    /// hash table. Since tables only grow (doubling), the replaced ones never
+    /// take more memory than the current one.
+    std::vector<std::unique_ptr<Table>> tables;
+  };
+
+  std::unique_ptr<Shard[]> shards;
+  size_t shards_count;
+  int shard_bits;
+
+  static size_t hash(const K &key)
+  {
+    // Fibonacci hashing spreads sequential keys towards the high bits of the
+    // hash, thus both shards and slots are picked from those.
+    return H{}(key) * 0x9E3779B97F4A7C15ull;
+  }
+
+  /// Reads a slot's field, which a writer may be storing to meanwhile.
+  template <typename T> static T load(const T &field)
+  {
+    auto &source = const_cast<T &>(field);
+    if constexpr (std::atomic_ref<T>::is_always_lock_free)
+    {
+      return std::atomic_ref(source).load(std::memory_order_relaxed);
+    }
+    else
+    {
+      T value;
+      auto *bytes = reinterpret_cast<unsigned char *>(&value);
+      auto *source_bytes = reinterpret_cast<unsigned char *>(&source);
+      for (size_t i = 0; i < sizeof(T); i++)
+      {
+        bytes[i] =
+            std::atomic_ref(source_bytes[i]).load(std::memory_order_relaxed);
+      }
+      return value;
+    }
+  }
+
+  /// Writes a slot's field, which readers may be loading meanwhile.
+  template <typename T> static void store(T &field, const T &value)
+  {
+    if constexpr (std::atomic_ref<T>::is_always_lock_free)
+    {
+      std::atomic_ref(field).store(value, std::memory_order_relaxed);
+    }
+    else
+    {
+      const auto *bytes = reinterpret_cast<const unsigned char *>(&value);
+      auto *target_bytes = reinterpret_cast<unsigned char *>(&field);
+      for (size_t i = 0; i < sizeof(T); i++)
+      {
+        std::atomic_ref(target_bytes[i])
+            .store(bytes[i], std::memory_order_relaxed);
+      }
+    }
+  }
+
+  static void store(Slot &slot, const K &key, const V &value)
+  {
+    store(slot.key, key);
+    store(slot.value, value);
+    store(slot.occupied, true);
+  }
+
+  Shard &shard_of(size_t hash) const
+  {
+    if (this->shard_bits == 0) return this->shards[0];
+    return this->shards[hash >> (64 - this->shard_bits)];
+  }
+
+  static void begin_write(Shard &shard)
+  {
+    const auto sequence = shard.sequence.load(std::memory_order_relaxed);
+    shard.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  static void end_write(Shard &shard)
+  {
+    const auto sequence = shard.sequence.load(std::memory_order_relaxed);
+    shard.sequence.store(sequence + 1, std::memory_order_release);
+  }
+
+  /**
+   * Looks `key` up in `table`, returning its slot index or `capacity` if
+   * the table does not contain it.
+   */
+  static size_t find_slot_of(const Table &table, const K &key, size_t hash)
+  {
+    const auto mask = table.capacity - 1;
+    auto probing = table.home_of(hash);
+
+    for (size_t steps = 0; steps < table.capacity; steps++)
+    {
+      const Slot &slot = table.slots[probing];
+      if (!load(slot.occupied)) break;
+      if (load(slot.key) == key) return probing;
+      probing = (probing + 1) & mask;
+    }
+
+    return table.capacity;
+  }
+
+  /**
+   * Places `key` and `value` in the first free slot of `table`. The caller
+   * must ensure the key is not in `table` yet and that there is room for it.
+   */
+  static void place(Table &table, const K &key, const V &value, size_t hash)
+  {
+    const auto mask = table.capacity - 1;
+    auto probing = table.home_of(hash);
+    while (table.slots[probing].occupied) probing = (probing + 1) & mask;
+    store(table.slots[probing], key, value);
+  }
+
+  /**
+   * Grows the shard's table if it is getting full. Readers keep probing the
+   * old table until the new one is published.
+   */
+  void maybe_resize(Shard &shard)
+  {
+    Table *table = shard.table.load(std::memory_order_relaxed);
+    const auto threshold = table->capacity / 2;
+    if (shard.size.load(std::memory_order_relaxed) < threshold) return;
+
+    auto new_table =
+        std::make_unique<Table>(table->capacity * 2, this->shard_bits);
+    for (size_t i = 0; i < table->capacity; i++)
+    {
+      const Slot &slot = table->slots[i];
+      if (!slot.occupied) continue;
+      place(*new_table, slot.key, slot.value, hash(slot.key));
+    }
+
+    begin_write(shard);
+    // publishes the new table's capacity and slots to readers.
+    shard.table.store(new_table.get(), std::memory_order_release);
+    end_write(shard);
+
+    shard.tables.push_back(std::move(new_table));
+  }
+
+  /**
+   * Frees `table.slots[index]` by shifting the following elements of its
+   * cluster backwards, so that no tombstones are ever needed.
+   */
+  static void erase_slot(Table &table, size_t index)
+  {
+    const auto mask = table.capacity - 1;
+    auto next = index;
+
+    while (true)
+    {
+      next = (next + 1) & mask;
+      Slot &slot = table.slots[next];
+      if (!slot.occupied) break;
+
+      const auto home = table.home_of(hash(slot.key));
+
+      // whether `home` lies cyclically in (index, next], in which case the
+      // element cannot be moved backwards to `index`.
+      const auto stays = index <= next ? (index < home && home <= next)
+                                       : (index < home || home <= next);
+      if (stays) continue;
+
+      store(table.slots[index], slot.key, slot.value);
+      index = next;
+    }
+
+    store(table.slots[index].occupied, false);
+  }
+
+public:
+  /**
+   * @param capacity The initial capacity, split across every shard.
+   * @param shards_count How many shards to split the keys into. It's rounded
+   * up to a power of two and, if zero, derived from the hardware concurrency.
+   */
+  ConcurrentHashTable(size_t capacity, size_t shards_count = 0)
+  {
+    if (shards_count == 0)
+    {
+      shards_count = std::max(1u, std::thread::hardware_concurrency()) * 4;
+    }
+
+    this->shards_count = std::bit_ceil(shards_count);
+    this->shard_bits = std::countr_zero(this->shards_count);
+    this->shards = std::make_unique<Shard[]>(this->shards_count);
+
+    const auto shard_capacity =
+        std::bit_ceil(std::max<size_t>(capacity / this->shards_count, 2));
+
+    for (size_t i = 0; i < this->shards_count; i++)
+    {
+      Shard &shard = this->shards[i];
+      shard.sequence.store(0, std::memory_order_relaxed);
+      shard.size.store(0, std::memory_order_relaxed);
+      shard.tables.push_back(
+          std::make_unique<Table>(shard_capacity, this->shard_bits));
+      shard.table.store(shard.tables.back().get(), std::memory_order_relaxed);
+    }
+  }
+
+  size_t size() const override final
+  {
+    size_t size = 0;
+    for (size_t i = 0; i < this->shards_count; i++)
+    {
+      size += this->shards[i].size.load(std::memory_order_relaxed);
+    }
+    return size;
+  }
+
+  size_t capacity() const
+  {
+    size_t capacity = 0;
+    for (size_t i = 0; i < this->shards_count; i++)
+    {
+      const Table *table =
+          this->shards[i].table.load(std::memory_order_acquire);
+      capacity += table->capacity;
+    }
+    return capacity;
+  }
+
+  void insert(K key, V value) noexcept(false) override final
+  {
+    const auto hash = ConcurrentHashTable::hash(key);
+    Shard &shard = this->shard_of(hash);
+    const std::lock_guard lock(shard.writers_mutex);
+
+    this->maybe_resize(shard);
+    Table &table = *shard.table.load(std::memory_order_relaxed);
+
+    const auto index = find_slot_of(table, key, hash);
+    if (index != table.capacity)
+    {
+      begin_write(shard);
+      store(table.slots[index].value, value);
+      end_write(shard);
+      return;
+    }
+
+    begin_write(shard);
+    place(table, key, value, hash);
+    end_write(shard);
+
+    shard.size.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  std::optional<V> get(K key) override final
+  {
+    const auto hash = ConcurrentHashTable::hash(key);
+    Shard &shard = this->shard_of(hash);
+
+    while (true)
+    {
+      const auto sequence = shard.sequence.load(std::memory_order_acquire);
+      if (sequence & 1)
+      {
+        std::this_thread::yield();
+        continue;
+      }
+
+      // A writer may be modifying this table as we read it, so the result is
+      // only trusted if the shard's sequence hasn't changed meanwhile.
+      const Table &table = *shard.table.load(std::memory_order_acquire);
+      const auto index = find_slot_of(table, key, hash);
+
+      std::optional<V> value = std::nullopt;
+      if (index != table.capacity) value = load(table.slots[index].value);
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (shard.sequence.load(std::memory_order_relaxed) == sequence)
+      {
+        return value;
+      }
+    }
+  }
+
+  void remove(K key) override final
+  {
+    const auto hash = ConcurrentHashTable::hash(key);
+    Shard &shard = this->shard_of(hash);
+    const std::lock_guard lock(shard.writers_mutex);
+
+    Table &table = *shard.table.load(std::memory_order_relaxed);
+    const auto index = find_slot_of(table, key, hash);
+    if (index == table.capacity) return;
+
+    begin_write(shard);
+    erase_slot(table, index);
+    end_write(shard);
+
+    shard.size.fetch_sub(1, std::memory_order_relaxed);
+  }
+};
+
+} // namespace core::hash_table
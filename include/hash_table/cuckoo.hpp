@@ -0,0 +1,337 @@
+#pragma once
+
+#include "hash_table.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace core::hash_table
+{
+
+/**
+ * A bucketized cuckoo hash table: every key may only live in one of the few
+ * slots of either of its two candidate buckets, so a lookup reads at most two
+ * buckets, whatever the load.
+ *
+ * Whenever both candidate buckets of a new key are full, a breadth-first
+ * search looks for the shortest chain of keys that can be moved to their
+ * alternative buckets to free a slot. If there's none, the table doubles.
+ *
+ * A bucket holds as many slots as fit in a cache line along with their
+ * occupancy byte, up to four, and is aligned to the line, so that a lookup
+ * touches at most two cache lines: 8-byte keys and values get three slots.
+ * Keys and values over 31 bytes together, of which not even two slots fit,
+ * get four slots spanning several lines. Both `K` and `V` must be default
+ * constructible.
+ */
+template <typename V, typename K = size_t, typename H = Hash<K>>
+class CuckooHashTable : public HashTable<V, K>
+{
+private:
+  /// How many slots fit in a cache line along with the occupancy byte.
+  static constexpr size_t slots_per_line = 63 / (sizeof(K) + sizeof(V));
+  static constexpr size_t slots_per_bucket =
+      slots_per_line < 2 ? 4 : std::min<size_t>(slots_per_line, 4);
+  /// How many buckets the displacement search may visit before giving up.
+  static constexpr size_t max_search_size = 512;
+
+  struct BucketData
+  {
+    K keys[slots_per_bucket];
+    V values[slots_per_bucket];
+    uint8_t occupied_slots;
+  };
+
+  struct alignas(sizeof(BucketData) <= 64 ? 64
+                                          : alignof(BucketData)) Bucket
+      : BucketData
+  {
+    bool is_occupied(size_t slot) const
+    {
+      return this->occupied_slots & (1 << slot);
+    }
+
+    /// The first free slot, or `slots_per_bucket` if the bucket is full.
+    size_t free_slot() const
+    {
+      return std::countr_one(this->occupied_slots);
+    }
+  };
+
+  /**
+   * A bucket reached by the displacement search, by moving the key at
+   * `parent_slot` of the `parent`-th visited bucket to its other bucket.
+   */
+  struct Visit
+  {
+    size_t bucket;
+    size_t parent;
+    size_t parent_slot;
+  };
+
+  std::unique_ptr<Bucket[]> buckets;
+  size_t buckets_count;
+  /// log2(buckets_count).
+  int buckets_bits;
+  size_t _size;
+
+  std::pair<size_t, size_t> buckets_of(const auto &key) const
+  {
+    const auto hash = H{}(key);
+    const auto shift = 64 - this->buckets_bits;
+    const size_t first = (hash * 0x9E3779B97F4A7C15ull) >> shift;
+    size_t second = (hash * 0xC2B2AE3D27D4EB4Full) >> shift;
+    if (second == first) second = first ^ 1;
+    return std::pair(first, second);
+  }
+
+  size_t alternative_bucket_of(const K &key, size_t bucket) const
+  {
+    const auto [first, second] = this->buckets_of(key);
+    return bucket == first ? second : first;
+  }
+
+  /// The slot of `key` within `bucket`, or `slots_per_bucket` if it's not
+  /// there.
+  size_t slot_of(const Bucket &bucket, const auto &key) const
+  {
+    for (size_t slot = 0; slot < slots_per_bucket; slot++)
+    {
+      if (bucket.is_occupied(slot) && bucket.keys[slot] == key) return slot;
+    }
+    return slots_per_bucket;
+  }
+
+  std::pair<Bucket *, size_t> find_slot_of(const auto &key) const
+  {
+    const auto [first, second] = this->buckets_of(key);
+
+    for (const auto index : {first, second})
+    {
+      Bucket &bucket = this->buckets[index];
+      const auto slot = this->slot_of(bucket, key);
+      if (slot != slots_per_bucket) return std::pair(&bucket, slot);
+    }
+
+    return std::pair(nullptr, slots_per_bucket);
+  }
+
+  void allocate(size_t buckets_count)
+  {
+    this->buckets_count = std::bit_ceil(std::max<size_t>(buckets_count, 2));
+    this->buckets_bits = std::countr_zero(this->buckets_count);
+    this->buckets = std::make_unique<Bucket[]>(this->buckets_count);
+  }
+
+  /**
+   * Searches for the shortest chain of displacements that frees a slot in
+   * one of `key`'s buckets, and performs it.
+   *
+   * @returns The bucket with a free slot, or `nullptr` if there's no chain
+   * within the search limit.
+   */
+  Bucket *make_room_for(const K &key)
+  {
+    const auto [first, second] = this->buckets_of(key);
+
+    std::vector<Visit> visits = {Visit{first, 0, 0}, Visit{second, 0, 0}};
+    visits.reserve(max_search_size);
+
+    for (size_t i = 0; i < visits.size(); i++)
+    {
+      const Bucket &bucket = this->buckets[visits[i].bucket];
+      if (bucket.free_slot() != slots_per_bucket)
+      {
+        return this->displace_along(visits, i);
+      }
+
+      for (size_t slot = 0; slot < slots_per_bucket; slot++)
+      {
+        if (visits.size() == max_search_size) return nullptr;
+
+        const auto alternative =
+            this->alternative_bucket_of(bucket.keys[slot], visits[i].bucket);
+        visits.push_back(Visit{alternative, i, slot});
+      }
+    }
+
+    return nullptr;
+  }
+
+  /**
+   * Moves every key along the path from the `last`-th visit back to one of
+   * the first two visits, which are the candidate buckets of the key being
+   * inserted. The `last`-th visited bucket must have a free slot.
+   *
+   * @returns The candidate bucket that got a free slot, or `nullptr` if the
+   * path turned out not to be feasible.
+   */
+  Bucket *displace_along(const std::vector<Visit> &visits, size_t last)
+  {
+    auto current = last;
+
+    while (current > 1)
+    {
+      const Visit &visit = visits[current];
+      const auto source_bucket = visits[visit.parent].bucket;
+      Bucket &target = this->buckets[visit.bucket];
+      Bucket &source = this->buckets[source_bucket];
+
+      // a path that crosses itself may have already moved the key expected
+      // at this slot. The moves done so far are still valid, though.
+      const K &key = source.keys[visit.parent_slot];
+      if (!source.is_occupied(visit.parent_slot) ||
+          this->alternative_bucket_of(key, source_bucket) != visit.bucket)
+      {
+        return nullptr;
+      }
+
+      const auto target_slot = target.free_slot();
+      target.keys[target_slot] = std::move(source.keys[visit.parent_slot]);
+      target.values[target_slot] = std::move(source.values[visit.parent_slot]);
+      target.occupied_slots |= 1 << target_slot;
+      source.occupied_slots &= ~(1 << visit.parent_slot);
+
+      current = visit.parent;
+    }
+
+    return &this->buckets[visits[current].bucket];
+  }
+
+  /**
+   * Places a key that is not in the table yet, moving from `key` and `value`
+   * only if it succeeds.
+   */
+  bool place(K &key, V &value)
+  {
+    Bucket *bucket = this->make_room_for(key);
+    if (!bucket) return false;
+
+    const auto slot = bucket->free_slot();
+    bucket->keys[slot] = std::move(key);
+    bucket->values[slot] = std::move(value);
+    bucket->occupied_slots |= 1 << slot;
+    this->_size++;
+    return true;
+  }
+
+  /**
+   * Moves every element out of the table, leaving it empty.
+   */
+  void drain_into(std::vector<std::pair<K, V>> &elements)
+  {
+    for (size_t i = 0; i < this->buckets_count; i++)
+    {
+      Bucket &bucket = this->buckets[i];
+      for (size_t slot = 0; slot < slots_per_bucket; slot++)
+      {
+        if (!bucket.is_occupied(slot)) continue;
+        elements.emplace_back(std::move(bucket.keys[slot]),
+                              std::move(bucket.values[slot]));
+      }
+      bucket.occupied_slots = 0;
+    }
+    this->_size = 0;
+  }
+
+  void rehash(size_t buckets_count)
+  {
+    std::vector<std::pair<K, V>> elements;
+    elements.reserve(this->_size);
+    this->drain_into(elements);
+
+    while (true)
+    {
+      this->allocate(buckets_count);
+
+      size_t placed = 0;
+      while (placed < elements.size() &&
+             this->place(elements[placed].first, elements[placed].second))
+      {
+        placed++;
+      }
+
+      if (placed == elements.size()) return;
+
+      // gives the elements placed so far back before retrying with more room.
+      elements.erase(elements.begin(), elements.begin() + placed);
+      this->drain_into(elements);
+      buckets_count *= 2;
+    }
+  }
+
+public:
+  /// How many bytes each bucket takes.
+  static constexpr size_t bucket_size = sizeof(Bucket);
+
+  CuckooHashTable(size_t capacity) : _size(0)
+  {
+    this->allocate((capacity + slots_per_bucket - 1) / slots_per_bucket);
+  }
+
+  size_t size() const override final { return this->_size; }
+
+  size_t capacity() const
+  {
+    return this->buckets_count * slots_per_bucket;
+  }
+
+  float load_factor() const
+  {
+    return (float)this->_size / (float)this->capacity();
+  }
+
+  void insert(K key, V value) noexcept(false) override final
+  {
+    if (V *current = this->find(key))
+    {
+      *current = std::move(value);
+      return;
+    }
+
+    while (!this->place(key, value)) this->rehash(this->buckets_count * 2);
+  }
+
+  /**
+   * Looks `key` up without copying its value.
+   *
+   * @returns A pointer to the key's value, that is valid until the next
+   * insertion, or `nullptr` if the key is not in the table.
+   */
+  V *find(const K &key)
+  {
+    auto [bucket, slot] = this->find_slot_of(key);
+    return bucket ? &bucket->values[slot] : nullptr;
+  }
+
+  const V *find(const K &key) const
+  {
+    auto [bucket, slot] = this->find_slot_of(key);
+    return bucket ? &bucket->values[slot] : nullptr;
+  }
+
+  std::optional<V> get(K key) override final
+  {
+    const V *value = this->find(key);
+    if (!value) return std::nullopt;
+    return *value;
+  }
+
+  void remove(K key) override final
+  {
+    auto [bucket, slot] = this->find_slot_of(key);
+    if (!bucket) return;
+
+    // releases whatever the removed key and value hold.
+    bucket->keys[slot] = K();
+    bucket->values[slot] = V();
+    bucket->occupied_slots &= ~(1 << slot);
+    this->_size--;
+  }
+};
+
+} // namespace core::hash_table
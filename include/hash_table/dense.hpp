@@ -0,0 +1,322 @@
+#pragma once
+
+#include "hash_table.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace core::hash_table
+{
+
+/**
+ * A hash table whose entries live contiguously, in insertion order, apart
+ * from an open addressing index that maps hashes to their positions.
+ *
+ * Scanning it means walking a packed array, and the index costs only eight
+ * bytes per slot, however empty it is. Removing an entry moves the last one
+ * into its place, so pointers into the table are only valid until the next
+ * insertion or removal.
+ */
+template <typename V, typename K = size_t, typename H = Hash<K>>
+class DenseHashTable : public HashTable<V, K>
+{
+private:
+  static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+  /// As homes are taken from 32-bit fingerprints, the index can't have more
+  /// slots. It has a free one for every entry even then, since there are
+  /// fewer than `npos` of them.
+  static constexpr size_t max_slots_count = size_t(1) << 32;
+
+  /**
+   * An index slot. Besides the entry's position, it holds the 32 upper bits
+   * of the entry's hash, so that most mismatching keys are discarded without
+   * reading the entry, and so that the slot's home can be recomputed.
+   */
+  struct Slot
+  {
+    uint32_t entry;
+    uint32_t fingerprint;
+  };
+
+  std::vector<std::pair<K, V>> entries;
+  std::unique_ptr<Slot[]> slots;
+  size_t slots_count;
+  /// log2(slots_count).
+  int slots_bits;
+
+  static uint32_t fingerprint_of(const auto &key)
+  {
+    // Fibonacci hashing leaves the well mixed bits at the top.
+    return (uint32_t)((H{}(key) * 0x9E3779B97F4A7C15ull) >> 32);
+  }
+
+  size_t home_of(uint32_t fingerprint) const
+  {
+    return fingerprint >> (32 - this->slots_bits);
+  }
+
+  size_t next_slot(size_t slot) const
+  {
+    return (slot + 1) & (this->slots_count - 1);
+  }
+
+  /**
+   * Finds the index slot pointing to `key`'s entry or, if there's none, the
+   * free slot where it'd be placed.
+   */
+  size_t find_slot_of(const auto &key, uint32_t fingerprint) const
+  {
+    auto slot = this->home_of(fingerprint);
+
+    while (true)
+    {
+      const Slot &current = this->slots[slot];
+      if (current.entry == npos) return slot;
+      if (current.fingerprint == fingerprint &&
+          this->entries[current.entry].first == key)
+      {
+        return slot;
+      }
+      slot = this->next_slot(slot);
+    }
+  }
+
+  /**
+   * Finds the index slot pointing to the entry at `entry`.
+   */
+  size_t find_slot_of_entry(uint32_t entry) const
+  {
+    const auto fingerprint = fingerprint_of(this->entries[entry].first);
+    auto slot = this->home_of(fingerprint);
+    while (this->slots[slot].entry != entry) slot = this->next_slot(slot);
+    return slot;
+  }
+
+  void maybe_resize()
+  {
+    if (this->entries.size() + 1 <= this->slots_count / 2 ||
+        this->slots_count == max_slots_count)
+    {
+      return;
+    }
+    this->resize(this->slots_count * 2);
+  }
+
+  void resize(size_t new_slots_count)
+  {
+    this->slots_count = new_slots_count;
+    this->slots_bits = std::countr_zero(new_slots_count);
+    this->slots = std::make_unique<Slot[]>(new_slots_count);
+    std::fill_n(this->slots.get(), new_slots_count, Slot{npos, 0});
+
+    for (uint32_t entry = 0; entry < this->entries.size(); entry++)
+    {
+      const auto fingerprint = fingerprint_of(this->entries[entry].first);
+      auto slot = this->home_of(fingerprint);
+      while (this->slots[slot].entry != npos) slot = this->next_slot(slot);
+      this->slots[slot] = Slot{entry, fingerprint};
+    }
+  }
+
+  /**
+   * Frees the index slot at `slot` by shifting the following slots of its
+   * cluster backwards, so that no tombstones are ever needed.
+   */
+  void erase_slot(size_t slot)
+  {
+    auto next = slot;
+
+    while (true)
+    {
+      next = this->next_slot(next);
+      const Slot &current = this->slots[next];
+      if (current.entry == npos) break;
+
+      const auto home = this->home_of(current.fingerprint);
+
+      // whether `home` lies cyclically in (slot, next], in which case the
+      // entry cannot be moved backwards to `slot`.
+      const auto stays = slot <= next ? (slot < home && home <= next)
+                                      : (slot < home || home <= next);
+      if (stays) continue;
+
+      this->slots[slot] = current;
+      slot = next;
+    }
+
+    this->slots[slot].entry = npos;
+  }
+
+  template <typename KK, typename... Args>
+  std::pair<V *, bool> try_emplace_key(KK &&key,
+                                       Args &&...args) noexcept(false)
+  {
+    if (this->entries.size() == npos)
+    {
+      throw std::runtime_error("Hash table is full");
+    }
+
+    this->maybe_resize();
+
+    const auto fingerprint = fingerprint_of(key);
+    const auto slot = this->find_slot_of(key, fingerprint);
+    if (this->slots[slot].entry != npos)
+    {
+      return std::pair(&this->entries[this->slots[slot].entry].second, false);
+    }
+
+    const auto entry = (uint32_t)this->entries.size();
+    this->entries.emplace_back(
+        std::piecewise_construct, std::forward_as_tuple(std::forward<KK>(key)),
+        std::forward_as_tuple(std::forward<Args>(args)...));
+    this->slots[slot] = Slot{entry, fingerprint};
+
+    return std::pair(&this->entries[entry].second, true);
+  }
+
+  template <typename KK, typename M>
+  std::pair<V *, bool> insert_or_assign_key(KK &&key,
+                                            M &&value) noexcept(false)
+  {
+    auto [value_ptr, is_insertion] =
+        this->try_emplace_key(std::forward<KK>(key), std::forward<M>(value));
+    if (!is_insertion) *value_ptr = std::forward<M>(value);
+    return std::pair(value_ptr, is_insertion);
+  }
+
+  V *find_key(const auto &key) const
+  {
+    const auto slot = this->find_slot_of(key, fingerprint_of(key));
+    const auto entry = this->slots[slot].entry;
+    if (entry == npos) return nullptr;
+    return const_cast<V *>(&this->entries[entry].second);
+  }
+
+public:
+  using iterator = typename std::vector<std::pair<K, V>>::const_iterator;
+  using const_iterator = iterator;
+
+  DenseHashTable(size_t capacity)
+  {
+    this->resize(std::min(std::bit_ceil(std::max<size_t>(capacity * 2, 8)),
+                          max_slots_count));
+    this->entries.reserve(capacity);
+  }
+
+  /**
+   * Walks over every key-value pair in insertion order, up to the first
+   * removal, which moves the last entry into the removed one's place.
+   */
+  iterator begin() const { return this->entries.cbegin(); }
+  iterator end() const { return this->entries.cend(); }
+
+  /**
+   * Every key-value pair in the table, packed together.
+   */
+  std::span<const std::pair<K, V>> elements() const { return this->entries; }
+
+  size_t size() const override final { return this->entries.size(); }
+  size_t capacity() const { return this->slots_count / 2; }
+
+  void insert(K key, V value) noexcept(false) override final
+  {
+    this->insert_or_assign(std::move(key), std::move(value));
+  }
+
+  /**
+   * Inserts `key` with a value constructed in place from `args`, unless the
+   * key is already present, in which case nothing is constructed nor moved.
+   *
+   * @returns A pointer to the key's value and whether an insertion happened.
+   */
+  template <typename... Args>
+  std::pair<V *, bool> try_emplace(const K &key, Args &&...args)
+  {
+    return this->try_emplace_key(key, std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  std::pair<V *, bool> try_emplace(K &&key, Args &&...args)
+  {
+    return this->try_emplace_key(std::move(key), std::forward<Args>(args)...);
+  }
+
+  /**
+   * Inserts `key` with `value`, or assigns `value` to the key's current value
+   * if it is already present.
+   *
+   * @returns A pointer to the key's value and whether an insertion happened.
+   */
+  template <typename M>
+  std::pair<V *, bool> insert_or_assign(const K &key, M &&value)
+  {
+    return this->insert_or_assign_key(key, std::forward<M>(value));
+  }
+
+  template <typename M>
+  std::pair<V *, bool> insert_or_assign(K &&key, M &&value)
+  {
+    return this->insert_or_assign_key(std::move(key), std::forward<M>(value));
+  }
+
+  /**
+   * Looks `key` up without copying its value.
+   *
+   * @returns A pointer to the key's value, that is valid until the next
+   * insertion or removal, or `nullptr` if the key is not in the table.
+   */
+  V *find(const K &key) { return this->find_key(key); }
+  const V *find(const K &key) const { return this->find_key(key); }
+
+  /**
+   * Looks up a key equal to `key` without building a `K` from it.
+   */
+  template <typename Q>
+    requires internal::HeterogeneousKey<Q, K, H>
+  V *find(const Q &key)
+  {
+    return this->find_key(key);
+  }
+
+  template <typename Q>
+    requires internal::HeterogeneousKey<Q, K, H>
+  const V *find(const Q &key) const
+  {
+    return this->find_key(key);
+  }
+
+  std::optional<V> get(K key) override final
+  {
+    const V *value = this->find(key);
+    if (!value) return std::nullopt;
+    return *value;
+  }
+
+  void remove(K key) override final
+  {
+    const auto slot = this->find_slot_of(key, fingerprint_of(key));
+    const auto entry = this->slots[slot].entry;
+    if (entry == npos) return;
+
+    this->erase_slot(slot);
+
+    const auto last = (uint32_t)this->entries.size() - 1;
+    if (entry != last)
+    {
+      this->slots[this->find_slot_of_entry(last)].entry = entry;
+      this->entries[entry] = std::move(this->entries[last]);
+    }
+
+    this->entries.pop_back();
+  }
+};
+
+} // namespace core::hash_table
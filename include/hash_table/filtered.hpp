@@ -0,0 +1,116 @@
+#pragma once
+
+#include "hash_table.hpp"
+#include "hash_table/bloom_filter.hpp"
+#include "hash_table/open_addressing.hpp"
+#include <optional>
+#include <utility>
+
+namespace core::hash_table
+{
+
+/**
+ * A hash table fronted by a Bloom filter, so that looking up a key that is
+ * not in the table costs a single cache line read, rather than a walk up to
+ * a free row or down a whole chain.
+ *
+ * `Table` may be either an `OAHashTable` or an `SCHashTable`. With a
+ * `CountingBloomFilter`, removed keys are cleared from the filter as well;
+ * with a plain `BloomFilter`, they keep costing a table lookup until the
+ * filter is rebuilt.
+ *
+ * The filter is sized for the table's initial capacity and rebuilt twice as
+ * large whenever the table outgrows it, keeping its false positive rate.
+ */
+template <typename V, typename K = size_t, typename H = Hash<K>,
+          typename Table = OAHashTable<V, K, H>,
+          typename Filter = CountingBloomFilter<K, H>>
+class FilteredHashTable : public HashTable<V, K>
+{
+private:
+  Table _table;
+  Filter _filter;
+  /// How many elements the filter is sized for.
+  size_t filter_capacity;
+  double false_positive_rate;
+
+  void rebuild_filter(size_t filter_capacity)
+  {
+    this->filter_capacity = filter_capacity;
+    this->_filter = Filter(filter_capacity, this->false_positive_rate);
+    for (const auto &[key, _] : this->_table) this->_filter.insert(key);
+  }
+
+public:
+  /**
+   * @param false_positive_rate The share of absent keys that still cost a
+   * table lookup, in (0, 1).
+   */
+  FilteredHashTable(size_t capacity,
+                    double false_positive_rate = 0.01) noexcept(false)
+      : _table(capacity), _filter(capacity, false_positive_rate),
+        filter_capacity(capacity), false_positive_rate(false_positive_rate)
+  {
+  }
+
+  const Table &table() const { return this->_table; }
+  const Filter &filter() const { return this->_filter; }
+
+  size_t size() const override final { return this->_table.size(); }
+
+  void insert(K key, V value) noexcept(false) override final
+  {
+    const auto hash = Filter::hash(key);
+    const auto is_insertion =
+        this->_table.insert_or_assign(std::move(key), std::move(value)).second;
+    if (!is_insertion) return;
+
+    if (this->_table.size() > this->filter_capacity)
+    {
+      this->rebuild_filter(this->filter_capacity * 2);
+    }
+    else
+    {
+      this->_filter.insert_hash(hash);
+    }
+  }
+
+  /**
+   * Looks `key` up without copying its value, skipping the table if the
+   * filter rules the key out.
+   *
+   * @returns A pointer to the key's value, or `nullptr` if the key is not in
+   * the table.
+   */
+  const V *find(const K &key) const
+  {
+    if (!this->_filter.contains(key)) return nullptr;
+    return this->_table.find(key);
+  }
+
+  V *find(const K &key)
+  {
+    if (!this->_filter.contains(key)) return nullptr;
+    return this->_table.find(key);
+  }
+
+  std::optional<V> get(K key) override final
+  {
+    if (!this->_filter.contains(key)) return std::nullopt;
+    return this->_table.get(std::move(key));
+  }
+
+  void remove(K key) override final
+  {
+    const auto hash = Filter::hash(key);
+    if (!this->_filter.contains_hash(hash) || !this->_table.find(key)) return;
+
+    this->_table.remove(std::move(key));
+    if constexpr (requires(Filter &filter) { filter.remove_hash(hash); })
+    {
+      this->_filter.remove_hash(hash);
+    }
+  }
+};
+
+} // namespace core::hash_table
@@ -0,0 +1,492 @@
+#pragma once
+
+#include "hash_table.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace core::hash_table
+{
+
+namespace internal
+{
+
+/**
+ * Unsigned integers packed one after another, each taking as many bits as the
+ * largest of them needs.
+ */
+class CompactArray
+{
+private:
+  std::vector<uint64_t> words;
+  uint32_t width;
+  uint64_t mask;
+
+public:
+  CompactArray() : width(0), mask(0) {}
+
+  CompactArray(std::span<const uint64_t> values)
+  {
+    uint64_t max = 0;
+    for (const auto value : values) max = std::max(max, value);
+
+    this->width = std::max<uint32_t>(std::bit_width(max), 1);
+    this->mask = this->width == 64 ? ~0ull : (1ull << this->width) - 1;
+    // one word more, so that reading the last value never overruns.
+    this->words.assign(values.size() * this->width / 64 + 2, 0);
+
+    for (size_t i = 0; i < values.size(); i++)
+    {
+      const auto bit = i * this->width;
+      const auto word = bit / 64;
+      const auto offset = bit % 64;
+
+      this->words[word] |= values[i] << offset;
+      if (offset + this->width > 64)
+      {
+        this->words[word + 1] |= values[i] >> (64 - offset);
+      }
+    }
+  }
+
+  uint64_t operator[](size_t i) const
+  {
+    const auto bit = i * this->width;
+    const auto word = bit / 64;
+    const auto offset = bit % 64;
+
+    auto value = this->words[word] >> offset;
+    if (offset + this->width > 64)
+    {
+      value |= this->words[word + 1] << (64 - offset);
+    }
+    return value & this->mask;
+  }
+
+  size_t bit_count() const { return this->words.size() * 64; }
+};
+
+} // namespace internal
+
+/**
+ * A read-only hash table built at once from a fixed key set, over a minimal
+ * perfect hash: every key maps to its own position of a dense array of
+ * elements, without collisions nor empty slots, so that a lookup reads the
+ * array exactly once.
+ *
+ * The hash follows PTHash (Pibiri and Trani, 2021). Keys are split into
+ * partitions, which are built independently and thus in parallel, and the
+ * keys of a partition into buckets. Each bucket, biggest first, gets the
+ * smallest "pilot" that sends all of its keys to free positions. Pilots are
+ * bit-packed, taking about 3 bits per key, and are all there is to the index
+ * besides the elements themselves.
+ *
+ * Looking up an absent key finds some other key's position, thus keys are
+ * stored along with their values to tell them apart.
+ */
+template <typename V, typename K = size_t, typename H = Hash<K>>
+class FrozenHashTable
+{
+private:
+  /// The average keys per partition.
+  static constexpr size_t partition_size = 1 << 16;
+  /// The average keys per bucket. Bigger buckets make for fewer pilots, but
+  /// bigger ones that take longer to find.
+  static constexpr double bucket_size = 5;
+  /// Partitions have a few more positions than keys, which makes the last
+  /// pilots much quicker to find. Keys sent to the extra positions are then
+  /// remapped to the free ones below the partition's size.
+  static constexpr double positions_load = 0.99;
+  /// Past this, a bucket's keys are assumed to never fit, and the whole table
+  /// is rebuilt with another seed.
+  static constexpr uint64_t max_pilot = 1 << 24;
+  static constexpr size_t max_attempts = 8;
+
+  struct Partition
+  {
+    /// Where the partition's elements, pilots and remapped positions begin.
+    size_t elements_offset;
+    size_t pilots_offset;
+    size_t remap_offset;
+    uint32_t size;
+    uint32_t buckets_count;
+    uint32_t positions_count;
+  };
+
+  /// A key as seen while building its partition.
+  struct Entry
+  {
+    uint64_t hash;
+    uint32_t bucket;
+    /// Its position within the building table's keys.
+    uint32_t index;
+  };
+
+  std::vector<std::pair<K, V>> elements;
+  std::vector<Partition> partitions;
+  internal::CompactArray pilots;
+  internal::CompactArray remap;
+  uint64_t seed;
+
+  uint64_t hash(const auto &key) const
+  {
+    return internal::mix(H{}(key) ^ this->seed);
+  }
+
+  const Partition &partition_of(uint64_t hash) const
+  {
+    return this->partitions[((hash >> 32) * this->partitions.size()) >> 32];
+  }
+
+  /**
+   * Skews keys towards the first buckets: 60% of them go to 30% of the
+   * buckets, which get their pilots first, while the positions are still
+   * mostly free.
+   */
+  static uint32_t bucket_of(uint64_t hash, uint32_t buckets_count)
+  {
+    const auto bucket_hash = internal::mix(hash);
+    const uint64_t dense_buckets = (buckets_count * 3 + 9) / 10;
+    const uint64_t sparse_buckets = buckets_count - dense_buckets;
+    const auto lower = bucket_hash & 0xFFFFFFFF;
+    const auto upper = bucket_hash >> 32;
+
+    if (sparse_buckets == 0 || lower < 0x9999999Aull)
+    {
+      return (uint32_t)((upper * dense_buckets) >> 32);
+    }
+    return (uint32_t)(dense_buckets + ((upper * sparse_buckets) >> 32));
+  }
+
+  static uint32_t position_of(uint64_t hash, uint64_t pilot,
+                              uint32_t positions_count)
+  {
+    return (uint32_t)((hash ^ internal::mix(pilot)) % positions_count);
+  }
+
+  size_t find_index_of(const auto &key) const
+  {
+    const auto hash = this->hash(key);
+    const Partition &partition = this->partition_of(hash);
+
+    const auto bucket = bucket_of(hash, partition.buckets_count);
+    const auto pilot = this->pilots[partition.pilots_offset + bucket];
+    size_t position = position_of(hash, pilot, partition.positions_count);
+    if (position >= partition.size)
+    {
+      position = this->remap[partition.remap_offset + position -
+                             partition.size];
+    }
+
+    return partition.elements_offset + position;
+  }
+
+  template <typename Q> const V *find_key(const Q &key) const
+  {
+    if (this->elements.empty()) return nullptr;
+
+    const auto &element = this->elements[this->find_index_of(key)];
+    if (!(element.first == key)) return nullptr;
+    return &element.second;
+  }
+
+  /**
+   * Finds the pilots of a partition, whose keys are `entries`, writing them
+   * to `pilots` and the keys' final positions to `positions`.
+   *
+   * @returns Whether it succeeded. It fails if two keys share a hash, or if a
+   * bucket's keys don't seem to fit in any way.
+   */
+  static bool build_partition(const Partition &partition,
+                              std::vector<Entry> &entries,
+                              std::span<const K> keys,
+                              std::vector<uint64_t> &pilots,
+                              std::vector<uint64_t> &remap,
+                              std::vector<size_t> &positions) noexcept(false)
+  {
+    if (partition.size == 0) return true;
+
+    std::ranges::sort(entries, [](const Entry &lhs, const Entry &rhs)
+                      { return std::tie(lhs.bucket, lhs.hash) <
+                               std::tie(rhs.bucket, rhs.hash); });
+
+    // equal hashes land on the same bucket, thus they're adjacent by now.
+    for (size_t i = 1; i < entries.size(); i++)
+    {
+      if (entries[i].hash != entries[i - 1].hash) continue;
+      if (keys[entries[i].index] == keys[entries[i - 1].index])
+      {
+        throw std::invalid_argument("Keys must be distinct");
+      }
+      return false;
+    }
+
+    std::vector<uint32_t> bucket_starts(partition.buckets_count + 1, 0);
+    for (const auto &entry : entries) bucket_starts[entry.bucket + 1]++;
+    for (uint32_t bucket = 0; bucket < partition.buckets_count; bucket++)
+    {
+      bucket_starts[bucket + 1] += bucket_starts[bucket];
+    }
+
+    std::vector<uint32_t> buckets(partition.buckets_count);
+    for (uint32_t bucket = 0; bucket < partition.buckets_count; bucket++)
+    {
+      buckets[bucket] = bucket;
+    }
+    std::ranges::stable_sort(
+        buckets, [&](uint32_t lhs, uint32_t rhs)
+        {
+          return bucket_starts[lhs + 1] - bucket_starts[lhs] >
+                 bucket_starts[rhs + 1] - bucket_starts[rhs];
+        });
+
+    std::vector<bool> taken(partition.positions_count, false);
+    std::vector<uint32_t> bucket_positions;
+
+    for (const auto bucket : buckets)
+    {
+      const auto first = bucket_starts[bucket];
+      const auto last = bucket_starts[bucket + 1];
+      if (first == last) break;
+
+      uint64_t pilot = 0;
+      while (true)
+      {
+        if (pilot == max_pilot) return false;
+
+        bucket_positions.clear();
+        for (auto i = first; i < last; i++)
+        {
+          const auto position = position_of(entries[i].hash, pilot,
+                                            partition.positions_count);
+          if (taken[position]) break;
+          taken[position] = true;
+          bucket_positions.push_back(position);
+        }
+
+        if (bucket_positions.size() == last - first) break;
+        for (const auto position : bucket_positions) taken[position] = false;
+        pilot++;
+      }
+
+      pilots[partition.pilots_offset + bucket] = pilot;
+    }
+
+    // sends the keys past the partition's size to the free positions before
+    // it, in order.
+    uint32_t free_position = 0;
+    for (auto position = partition.size; position < partition.positions_count;
+         position++)
+    {
+      if (!taken[position]) continue;
+      while (taken[free_position]) free_position++;
+      remap[partition.remap_offset + position - partition.size] =
+          free_position++;
+    }
+
+    for (const auto &entry : entries)
+    {
+      const auto pilot = pilots[partition.pilots_offset + entry.bucket];
+      size_t position =
+          position_of(entry.hash, pilot, partition.positions_count);
+      if (position >= partition.size)
+      {
+        position = remap[partition.remap_offset + position - partition.size];
+      }
+      positions[entry.index] = partition.elements_offset + position;
+    }
+
+    return true;
+  }
+
+  bool build(std::span<const K> keys, std::span<const V> values,
+             size_t threads_count) noexcept(false)
+  {
+    const auto partitions_count = std::max<size_t>(
+        (keys.size() + partition_size - 1) / partition_size, 1);
+
+    // groups the keys by partition.
+    std::vector<std::vector<Entry>> partition_entries(partitions_count);
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+      const auto hash = this->hash(keys[i]);
+      const auto partition = ((hash >> 32) * partitions_count) >> 32;
+      partition_entries[partition].push_back(Entry{hash, 0, (uint32_t)i});
+    }
+
+    this->partitions.clear();
+    size_t elements_offset = 0;
+    size_t pilots_offset = 0;
+    size_t remap_offset = 0;
+
+    for (auto &entries : partition_entries)
+    {
+      const auto size = (uint32_t)entries.size();
+      const auto buckets_count = std::max<uint32_t>(
+          (uint32_t)std::ceil(size / bucket_size), 1);
+      const auto positions_count = std::max<uint32_t>(
+          (uint32_t)std::ceil(size / positions_load), 1);
+
+      for (auto &entry : entries)
+      {
+        entry.bucket = bucket_of(entry.hash, buckets_count);
+      }
+
+      this->partitions.push_back(Partition{
+          .elements_offset = elements_offset,
+          .pilots_offset = pilots_offset,
+          .remap_offset = remap_offset,
+          .size = size,
+          .buckets_count = buckets_count,
+          .positions_count = positions_count,
+      });
+
+      elements_offset += size;
+      pilots_offset += buckets_count;
+      remap_offset += positions_count - std::min(size, positions_count);
+    }
+
+    std::vector<uint64_t> pilots(pilots_offset, 0);
+    std::vector<uint64_t> remap(remap_offset, 0);
+    std::vector<size_t> positions(keys.size());
+
+    std::atomic<size_t> next_partition = 0;
+    std::atomic<bool> failed = false;
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    const auto work = [&]
+    {
+      size_t partition;
+      while (!failed && (partition = next_partition++) < partitions_count)
+      {
+        try
+        {
+          if (!build_partition(this->partitions[partition],
+                               partition_entries[partition], keys, pilots,
+                               remap, positions))
+          {
+            failed = true;
+          }
+        }
+        catch (...)
+        {
+          const std::lock_guard lock(error_mutex);
+          error = std::current_exception();
+          failed = true;
+        }
+      }
+    };
+
+    std::vector<std::thread> threads;
+    const auto workers = std::min(threads_count, partitions_count);
+    for (size_t i = 1; i < workers; i++) threads.emplace_back(work);
+    work();
+    for (auto &thread : threads) thread.join();
+
+    if (error) std::rethrow_exception(error);
+    if (failed) return false;
+
+    // lays the elements out in their positions' order.
+    std::vector<size_t> key_at(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) key_at[positions[i]] = i;
+
+    this->elements.clear();
+    this->elements.reserve(keys.size());
+    for (const auto i : key_at) this->elements.emplace_back(keys[i], values[i]);
+
+    this->pilots = internal::CompactArray(pilots);
+    this->remap = internal::CompactArray(remap);
+    return true;
+  }
+
+public:
+  using iterator = typename std::vector<std::pair<K, V>>::const_iterator;
+  using const_iterator = iterator;
+
+  /**
+   * Builds the table from every key of `keys`, which must be distinct, with
+   * the value at the same position of `values`.
+   *
+   * @param threads_count How many threads build the partitions. If zero,
+   * it's the hardware concurrency.
+   */
+  FrozenHashTable(std::span<const K> keys, std::span<const V> values,
+                  size_t threads_count = 0) noexcept(false)
+  {
+    if (values.size() < keys.size())
+    {
+      throw std::invalid_argument("There must be a value for each key");
+    }
+    if (keys.size() > std::numeric_limits<uint32_t>::max())
+    {
+      throw std::invalid_argument("Too many keys");
+    }
+
+    if (threads_count == 0)
+    {
+      threads_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (size_t attempt = 0; attempt < max_attempts; attempt++)
+    {
+      this->seed = internal::mix(attempt + 1);
+      if (this->build(keys, values, threads_count)) return;
+    }
+
+    throw std::runtime_error("Could not find a perfect hash for the keys");
+  }
+
+  iterator begin() const { return this->elements.cbegin(); }
+  iterator end() const { return this->elements.cend(); }
+
+  size_t size() const { return this->elements.size(); }
+
+  /**
+   * How many bits the index takes per key, besides the elements.
+   */
+  double index_bits_per_key() const
+  {
+    const auto bits = this->pilots.bit_count() + this->remap.bit_count() +
+                      this->partitions.size() * sizeof(Partition) * 8;
+    return (double)bits / (double)std::max<size_t>(this->elements.size(), 1);
+  }
+
+  /**
+   * Looks `key` up without copying its value.
+   *
+   * @returns A pointer to the key's value, or `nullptr` if the key is not in
+   * the table.
+   */
+  const V *find(const K &key) const { return this->find_key(key); }
+
+  /**
+   * Looks up a key equal to `key` without building a `K` from it.
+   */
+  template <typename Q>
+    requires internal::HeterogeneousKey<Q, K, H>
+  const V *find(const Q &key) const
+  {
+    return this->find_key(key);
+  }
+
+  std::optional<V> get(const K &key) const
+  {
+    const V *value = this->find(key);
+    if (!value) return std::nullopt;
+    return *value;
+  }
+};
+
+} // namespace core::hash_table
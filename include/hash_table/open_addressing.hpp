@@ -1,30 +1,42 @@
 #pragma once
 
 #include "hash_table.hpp"
+#include "hash_table/probing.hpp"
+#include "hash_table/snapshot.hpp"
 #include "iostream"
+#include "utils.hpp"
+#include <algorithm>
+#include <bit>
 #include <cassert>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstring>
 #include <exception>
+#include <fstream>
+#include <iterator>
 #include <list>
 #include <memory>
 #include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace core::hash_table
 {
 
-namespace internal
-{
-
-enum class State
-{
-  Free,
-  Occupied,
-  Deleted,
-};
-
-}
-
-template <typename V, typename K = size_t>
+/**
+ * An open addressing hash table, which probes its rows as `Probing` dictates
+ * — linearly, unless told otherwise. See `LinearProbing`, `QuadraticProbing`
+ * and `DoubleHashing`. The policy is resolved at compile time, so probing
+ * costs no indirect calls whatsoever.
+ */
+template <typename V, typename K = size_t, typename H = Hash<K>,
+          ProbingPolicy Probing = LinearProbing>
 class OAHashTable : public HashTable<V, K>
 {
 
@@ -37,9 +49,16 @@ private:
 
     Row() : element(std::nullopt), state(internal::State::Free) {}
 
-    void set_element(K key, V value)
+    /**
+     * Constructs the element in place from `key` and the arguments of `V`'s
+     * constructor.
+     */
+    template <typename KK, typename... Args>
+    void set_element(KK &&key, Args &&...args)
     {
-      this->element = std::pair(key, value);
+      this->element.emplace(std::piecewise_construct,
+                            std::forward_as_tuple(std::forward<KK>(key)),
+                            std::forward_as_tuple(std::forward<Args>(args)...));
       this->state = internal::State::Occupied;
     }
 
@@ -66,7 +85,7 @@ private:
       return false;
     }
 
-    bool owns_key(const K &key) const
+    template <typename Q> bool owns_key(const Q &key) const
     {
       assert((!this->is_occupied() || this->element.has_value()) &&
              "Occupied rows MUST have an element value.");
@@ -77,95 +96,203 @@ private:
 
   std::unique_ptr<Row[]> internal_list;
   size_t internal_list_size;
+  /// The table never shrinks on its own below the capacity it started with.
+  size_t min_internal_list_size;
   size_t _size;
+  size_t tombstones;
   bool forbid_resize;
+  size_t resize_count;
+  size_t purge_count;
+  std::chrono::nanoseconds resize_duration;
+  [[no_unique_address]] mutable internal::ProbeCounters probe_counters;
 
-  size_t hash(K key) const { return key % this->internal_list_size; }
-
-  size_t advance_hash(size_t hash, size_t steps) const
-  {
-    return (hash + steps) % this->internal_list_size;
-  }
+  using Sequence = typename Probing::Sequence;
 
-  float load_factor() const
+  template <typename Q> Sequence probe_sequence_of(const Q &key) const
   {
-    return (float)this->_size / (float)this->internal_list_size;
+    return Sequence(H{}(key), this->internal_list_size);
   }
 
+  /**
+   * Makes room before an insertion once over half the rows are taken,
+   * tombstones included, since only free rows stop a miss' probing. If the
+   * elements alone take at most 3/8 of the rows, tombstones take over 1/8,
+   * and purging them makes enough room without growing.
+   */
   void maybe_resize()
   {
     const auto threshold = this->internal_list_size / 2.0;
-    if (this->_size <= threshold || this->forbid_resize) return;
+    if (this->_size + this->tombstones <= threshold) return;
+
+    if (this->_size <= this->internal_list_size * 3 / 8)
+    {
+      this->purge_tombstones();
+      return;
+    }
+
+    if (this->forbid_resize) return;
     this->resize(this->internal_list_size * 2);
   }
 
+  /**
+   * Halves the table after a removal once it's under an eighth full, so that
+   * it's still under a quarter full afterwards and far from growing again.
+   */
+  void maybe_shrink()
+  {
+    const auto threshold = this->internal_list_size / 8.0;
+    const auto new_internal_list_size = this->internal_list_size / 2;
+    if (this->_size >= threshold || this->forbid_resize ||
+        new_internal_list_size < this->min_internal_list_size)
+    {
+      return;
+    }
+
+    this->resize(new_internal_list_size);
+  }
+
   void resize(size_t new_internal_list_size)
   {
+    const auto timer = internal::ScopedTimer(this->resize_duration);
+    this->resize_count++;
+    // reinsertions aren't operations on the table.
+    const auto probe_counters = this->probe_counters;
+
     auto old_internal_list_size = this->internal_list_size;
     auto old_list = std::move(this->internal_list);
 
     this->internal_list_size = new_internal_list_size;
     this->internal_list = std::make_unique<Row[]>(new_internal_list_size);
     this->_size = 0;
+    this->tombstones = 0;
 
     for (size_t i = 0; i < old_internal_list_size; i++)
     {
       Row &row = old_list[i];
       if (!row.is_occupied()) continue;
-      this->insert(row.element->first, row.element->second);
+      this->insert(std::move(row.element->first),
+                   std::move(row.element->second));
+    }
+
+    this->probe_counters = probe_counters;
+  }
+
+  /**
+   * Rehashes the table onto its own rows, turning every tombstone back into a
+   * free row without allocating a second array.
+   *
+   * Every element is first marked as pending, reusing the deleted state, and
+   * every tombstone as free. Then each pending element is moved to the first
+   * row of its probing sequence that is not taken by an already placed one:
+   * either it stays, or it moves to a free row, or it swaps places with
+   * another pending element, which is then placed in turn. Placed elements
+   * never move again, so every row a placed element's lookup walks past stays
+   * taken.
+   */
+  void purge_tombstones()
+  {
+    using namespace internal;
+
+    const auto timer = ScopedTimer(this->resize_duration);
+    this->purge_count++;
+
+    for (size_t i = 0; i < this->internal_list_size; i++)
+    {
+      Row &row = this->internal_list[i];
+      row.state = row.is_occupied() ? State::Deleted : State::Free;
+    }
+    this->tombstones = 0;
+
+    for (size_t i = 0; i < this->internal_list_size; i++)
+    {
+      Row &row = this->internal_list[i];
+
+      while (row.is_deleted())
+      {
+        auto sequence = this->probe_sequence_of(row.element->first);
+        while (this->internal_list[sequence.row()].is_occupied())
+        {
+          sequence.next();
+        }
+
+        Row &target = this->internal_list[sequence.row()];
+        if (&target == &row)
+        {
+          row.state = State::Occupied;
+        }
+        else if (target.is_free())
+        {
+          target.element = std::move(row.element);
+          target.state = State::Occupied;
+          row.element = std::nullopt;
+          row.state = State::Free;
+        }
+        else
+        {
+          // the target's pending element takes this row, and is placed next.
+          std::swap(target.element, row.element);
+          target.state = State::Occupied;
+        }
+      }
     }
   }
 
-  std::optional<size_t> find_internal_index_of(K key)
+  template <typename Q>
+  std::optional<size_t> find_internal_index_of(const Q &key) const
+  {
+    return this->find_internal_index_of(key, this->probe_sequence_of(key));
+  }
+
+  template <typename Q>
+  std::optional<size_t> find_internal_index_of(const Q &key,
+                                               Sequence sequence) const
   {
     using namespace internal;
-    const auto hash = this->hash(key);
 
     size_t steps = 0;
-    auto probing = this->advance_hash(hash, steps);
 
     while (steps < this->internal_list_size)
     {
-      Row &row = this->internal_list[probing];
+      const Row &row = this->internal_list[sequence.row()];
 
       if (row.is_free()) break;
-      if (row.is_occupied() && row.owns_key(key)) return probing;
-      probing = this->advance_hash(hash, ++steps);
+      if (row.is_occupied() && row.owns_key(key))
+      {
+        this->probe_counters.count(steps + 1);
+        return sequence.row();
+      }
+      sequence.next();
+      steps++;
     }
 
+    this->probe_counters.count(std::min(steps + 1, this->internal_list_size));
     return std::nullopt;
   }
 
-public:
-  OAHashTable(size_t capacity)
-      : internal_list_size(capacity), _size(0), forbid_resize(false)
+  /**
+   * Finds the row `key` should be written to: the row that already owns it or,
+   * if there is none, a deleted or free row from its probing sequence.
+   *
+   * @returns The row and whether writing to it will be an insertion.
+   */
+  std::pair<Row *, bool> find_placement_for(const K &key) noexcept(false)
   {
-    this->internal_list = std::make_unique<Row[]>(internal_list_size);
+    return this->find_placement_for(key, this->probe_sequence_of(key));
   }
 
-  void forbid_resizing() { this->forbid_resize = true; }
-  void allow_resizing() { this->forbid_resize = false; }
-
-  size_t size() const override final { return this->_size; }
-  size_t capacity() const { return this->internal_list_size; }
-
-  void insert(K key, V value) noexcept(false) override final
+  std::pair<Row *, bool> find_placement_for(const K &key,
+                                            Sequence sequence) noexcept(false)
   {
     using namespace internal;
 
-    this->maybe_resize();
-
-    const auto hash = this->hash(key);
-
     Row *best_placement = nullptr;
     bool is_insertion = false;
 
     size_t given_steps = 0;
-    size_t probing = this->advance_hash(hash, given_steps);
 
     while (given_steps < this->internal_list_size)
     {
-      Row &row = this->internal_list[probing];
+      Row &row = this->internal_list[sequence.row()];
 
       // If it's free it means this key haven't ever been inserted before,
       // otherwise it would be deleted.
@@ -191,20 +318,516 @@ public:
         is_insertion = true;
       }
 
-      probing = this->advance_hash(hash, ++given_steps);
+      sequence.next();
+      given_steps++;
     }
 
+    this->probe_counters.count(
+        std::min(given_steps + 1, this->internal_list_size));
+
     if (!best_placement) throw std::runtime_error("Hash table is full");
 
-    best_placement->set_element(key, value);
-    if (is_insertion) this->_size++;
+    return std::pair(best_placement, is_insertion);
   }
 
-  std::optional<V> get(K key) override final
+  template <typename Q> V *find_key(const Q &key) const
   {
     auto internal_index = this->find_internal_index_of(key);
-    if (!internal_index.has_value()) return std::nullopt;
-    return this->internal_list[*internal_index].element->second;
+    if (!internal_index.has_value()) return nullptr;
+    return &this->internal_list[*internal_index].element->second;
+  }
+
+  template <typename KK, typename... Args>
+  std::pair<V *, bool> try_emplace_key(KK &&key, Args &&...args) noexcept(false)
+  {
+    this->maybe_resize();
+
+    auto [row, is_insertion] = this->find_placement_for(key);
+    if (is_insertion)
+    {
+      if (row->is_deleted()) this->tombstones--;
+      row->set_element(std::forward<KK>(key), std::forward<Args>(args)...);
+      this->_size++;
+    }
+
+    return std::pair(&row->element->second, is_insertion);
+  }
+
+  template <typename KK, typename M>
+  std::pair<V *, bool> insert_or_assign_key(KK &&key, M &&value) noexcept(false)
+  {
+    auto [value_ptr, is_insertion] =
+        this->try_emplace_key(std::forward<KK>(key), std::forward<M>(value));
+    if (!is_insertion) *value_ptr = std::forward<M>(value);
+    return std::pair(value_ptr, is_insertion);
+  }
+
+  /**
+   * Calls `resolve(i, sequence)` for every key of `keys`, in order, while
+   * keeping the home rows of the next `prefetch_distance` keys being
+   * prefetched.
+   */
+  template <typename F>
+  void for_each_hashed(std::span<const K> keys, size_t prefetch_distance,
+                       F &&resolve) const
+  {
+    constexpr size_t chunk_size = 256;
+    Sequence sequences[chunk_size];
+
+    for (size_t offset = 0; offset < keys.size(); offset += chunk_size)
+    {
+      const auto chunk = keys.subspan(
+          offset, std::min(chunk_size, keys.size() - offset));
+      const auto distance = std::min(prefetch_distance, chunk.size());
+
+      for (size_t i = 0; i < chunk.size(); i++)
+      {
+        sequences[i] = this->probe_sequence_of(chunk[i]);
+      }
+
+      for (size_t i = 0; i < distance; i++)
+      {
+        utils::prefetch(&this->internal_list[sequences[i].row()]);
+      }
+
+      for (size_t i = 0; i < chunk.size(); i++)
+      {
+        if (i + distance < chunk.size())
+        {
+          utils::prefetch(
+              &this->internal_list[sequences[i + distance].row()]);
+        }
+        resolve(offset + i, sequences[i]);
+      }
+    }
+  }
+
+public:
+  /**
+   * Walks over every key-value pair in the table, in no particular order.
+   * Keys may not be changed through it, thus it's always constant.
+   */
+  class Iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::pair<K, V>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type *;
+    using reference = const value_type &;
+
+    Iterator() : row(nullptr), last_row(nullptr) {}
+
+    Iterator(const Row *row, const Row *last_row)
+        : row(row), last_row(last_row)
+    {
+      this->skip_unoccupied_rows();
+    }
+
+    reference operator*() const { return *this->row->element; }
+    pointer operator->() const { return &*this->row->element; }
+
+    Iterator &operator++()
+    {
+      this->row++;
+      this->skip_unoccupied_rows();
+      return *this;
+    }
+
+    Iterator operator++(int)
+    {
+      auto previous = *this;
+      ++*this;
+      return previous;
+    }
+
+    bool operator==(const Iterator &other) const
+    {
+      return this->row == other.row;
+    }
+
+  private:
+    const Row *row;
+    const Row *last_row;
+
+    void skip_unoccupied_rows()
+    {
+      while (this->row != this->last_row && !this->row->is_occupied())
+      {
+        this->row++;
+      }
+    }
+  };
+
+  using iterator = Iterator;
+  using const_iterator = Iterator;
+
+  /// How many bytes each row takes, for sizing tables to a memory budget.
+  static constexpr size_t row_size = sizeof(Row);
+
+  /**
+   * @param capacity How many rows the table starts with. Probing policies
+   * that require it round it up to a power of two.
+   */
+  OAHashTable(size_t capacity)
+      : internal_list_size(Probing::power_of_two_capacity
+                               ? std::bit_ceil(std::max<size_t>(capacity, 1))
+                               : capacity),
+        min_internal_list_size(internal_list_size), _size(0), tombstones(0),
+        forbid_resize(false), resize_count(0), purge_count(0),
+        resize_duration(0)
+  {
+    this->internal_list = std::make_unique<Row[]>(internal_list_size);
+  }
+
+  Iterator begin() const
+  {
+    const Row *rows = this->internal_list.get();
+    return Iterator(rows, rows + this->internal_list_size);
+  }
+
+  Iterator end() const
+  {
+    const Row *last_row = this->internal_list.get() + this->internal_list_size;
+    return Iterator(last_row, last_row);
+  }
+
+  /**
+   * Saves the table to `path` as a snapshot, from which `open_mapped` can
+   * serve lookups without loading it back.
+   */
+  void save(const std::string &path) const noexcept(false)
+    requires std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>
+  {
+    using namespace internal;
+    using SnapshotRow = internal::SnapshotRow<K, V>;
+
+    auto file = std::ofstream(path, std::ios::binary | std::ios::trunc);
+    if (!file) throw std::runtime_error("Could not open \"" + path + "\"");
+
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, snapshot_magic, sizeof(snapshot_magic));
+    header.version = snapshot_version;
+    header.key_size = sizeof(K);
+    header.value_size = sizeof(V);
+    header.row_size = sizeof(SnapshotRow);
+    header.probing = Probing::id;
+    header.capacity = this->internal_list_size;
+    header.size = this->_size;
+    header.rows_offset = (sizeof(header) + snapshot_rows_alignment - 1) /
+                         snapshot_rows_alignment * snapshot_rows_alignment;
+
+    // the header is rewritten once the rows' checksum is known.
+    const auto padding = std::vector<char>(header.rows_offset, 0);
+    file.write(padding.data(), padding.size());
+
+    const size_t chunk_size = 1 << 16;
+    auto chunk = std::vector<SnapshotRow>(
+        std::min<size_t>(chunk_size, this->internal_list_size));
+    header.checksum = checksum({});
+
+    for (size_t offset = 0; offset < this->internal_list_size;
+         offset += chunk_size)
+    {
+      const auto count =
+          std::min<size_t>(chunk_size, this->internal_list_size - offset);
+
+      // zeroes the rows' padding too, so that the checksum is deterministic.
+      std::memset(chunk.data(), 0, count * sizeof(SnapshotRow));
+      for (size_t i = 0; i < count; i++)
+      {
+        const Row &row = this->internal_list[offset + i];
+        chunk[i].state = row.state;
+        if (!row.is_occupied()) continue;
+        chunk[i].key = row.element->first;
+        chunk[i].value = row.element->second;
+      }
+
+      const auto bytes = std::as_bytes(std::span(chunk.data(), count));
+      header.checksum = checksum(bytes, header.checksum);
+      file.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+    }
+
+    file.seekp(0);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.flush();
+    if (!file) throw std::runtime_error("Could not write \"" + path + "\"");
+  }
+
+  /**
+   * Maps a snapshot written by `save` into memory, serving lookups straight
+   * from it. See `MappedOAHashTable`.
+   */
+  static MappedOAHashTable<V, K, H, Probing>
+  open_mapped(const std::string &path,
+              bool verify_checksum = false) noexcept(false)
+  {
+    return MappedOAHashTable<V, K, H, Probing>(path, verify_checksum);
+  }
+
+  void forbid_resizing() { this->forbid_resize = true; }
+  void allow_resizing() { this->forbid_resize = false; }
+
+  size_t size() const override final { return this->_size; }
+  size_t capacity() const { return this->internal_list_size; }
+
+  float load_factor() const
+  {
+    return (float)this->_size / (float)this->internal_list_size;
+  }
+
+  /**
+   * Scans the whole table to report how its keys are spread. A key's probe
+   * length is how many rows of its probing sequence precede its own, plus
+   * one.
+   */
+  HashTableStats stats() const
+  {
+    auto stats = HashTableStats{};
+    stats.size = this->_size;
+    stats.capacity = this->internal_list_size;
+    stats.load_factor = this->load_factor();
+    stats.resize_count = this->resize_count;
+    stats.purge_count = this->purge_count;
+    stats.resize_duration = this->resize_duration;
+    this->probe_counters.report(stats);
+
+    size_t tombstones = 0;
+    std::optional<size_t> first_free_row;
+
+    for (size_t i = 0; i < this->internal_list_size; i++)
+    {
+      const Row &row = this->internal_list[i];
+
+      if (row.is_deleted()) tombstones++;
+      if (row.is_free() && !first_free_row) first_free_row = i;
+      if (!row.is_occupied()) continue;
+
+      auto sequence = this->probe_sequence_of(row.element->first);
+      size_t probe_length = 1;
+      while (sequence.row() != i)
+      {
+        sequence.next();
+        probe_length++;
+      }
+
+      if (stats.probe_histogram.size() <= probe_length)
+      {
+        stats.probe_histogram.resize(probe_length + 1, 0);
+      }
+      stats.probe_histogram[probe_length]++;
+    }
+
+    stats.tombstone_ratio = (float)tombstones / (float)stats.capacity;
+    internal::summarize_probes(stats);
+
+    // clusters may wrap around the table's end, thus they're measured
+    // starting from a free row.
+    if (!first_free_row)
+    {
+      stats.longest_cluster = this->internal_list_size;
+      return stats;
+    }
+
+    size_t cluster = 0;
+    for (size_t steps = 1; steps <= this->internal_list_size; steps++)
+    {
+      const auto i = (*first_free_row + steps) % this->internal_list_size;
+      cluster = this->internal_list[i].is_free() ? 0 : cluster + 1;
+      stats.longest_cluster = std::max(stats.longest_cluster, cluster);
+    }
+
+    return stats;
+  }
+
+  /**
+   * Grows the table at once so that it holds `count` elements without
+   * resizing again. Does nothing if resizing is forbidden.
+   */
+  void reserve(size_t count)
+  {
+    if (this->forbid_resize) return;
+
+    auto new_internal_list_size = std::max<size_t>(this->internal_list_size, 1);
+    while (count > new_internal_list_size / 2.0) new_internal_list_size *= 2;
+
+    if (new_internal_list_size == this->internal_list_size) return;
+    this->resize(new_internal_list_size);
+  }
+
+  /**
+   * Shrinks the table to the smallest capacity that holds its elements at
+   * most half full, which also drops every tombstone. If resizing is
+   * forbidden, it only purges the tombstones in place.
+   */
+  void shrink_to_fit()
+  {
+    if (this->forbid_resize)
+    {
+      if (this->tombstones) this->purge_tombstones();
+      return;
+    }
+
+    auto new_internal_list_size = std::max<size_t>(this->_size * 2, 1);
+    if constexpr (Probing::power_of_two_capacity)
+    {
+      new_internal_list_size = std::bit_ceil(new_internal_list_size);
+    }
+
+    this->min_internal_list_size =
+        std::min(this->min_internal_list_size, new_internal_list_size);
+    this->resize(new_internal_list_size);
+  }
+
+  void insert(K key, V value) noexcept(false) override final
+  {
+    this->insert_or_assign(std::move(key), std::move(value));
+  }
+
+  /**
+   * Inserts `key` with a value constructed in place from `args`, unless the
+   * key is already present, in which case nothing is constructed nor moved.
+   *
+   * @returns A pointer to the key's value, that is valid until the next
+   * insertion or removal, and whether an insertion happened.
+   */
+  template <typename... Args>
+  std::pair<V *, bool> try_emplace(const K &key, Args &&...args)
+  {
+    return this->try_emplace_key(key, std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  std::pair<V *, bool> try_emplace(K &&key, Args &&...args)
+  {
+    return this->try_emplace_key(std::move(key), std::forward<Args>(args)...);
+  }
+
+  /**
+   * Inserts `key` with `value`, or assigns `value` to the key's current value
+   * if it is already present.
+   *
+   * @returns A pointer to the key's value, that is valid until the next
+   * insertion or removal, and whether an insertion happened.
+   */
+  template <typename M>
+  std::pair<V *, bool> insert_or_assign(const K &key, M &&value)
+  {
+    return this->insert_or_assign_key(key, std::forward<M>(value));
+  }
+
+  template <typename M>
+  std::pair<V *, bool> insert_or_assign(K &&key, M &&value)
+  {
+    return this->insert_or_assign_key(std::move(key),
+                                     std::forward<M>(value));
+  }
+
+  /**
+   * Looks `key` up without copying its value.
+   *
+   * @returns A pointer to the key's value, that is valid until the next
+   * insertion or removal, as either may rehash the table, or `nullptr` if
+   * the key is not in the table.
+   */
+  V *find(const K &key) { return this->find_key(key); }
+  const V *find(const K &key) const { return this->find_key(key); }
+
+  /**
+   * Looks up a key equal to `key` without building a `K` from it.
+   */
+  template <typename Q>
+    requires internal::HeterogeneousKey<Q, K, H>
+  V *find(const Q &key)
+  {
+    return this->find_key(key);
+  }
+
+  template <typename Q>
+    requires internal::HeterogeneousKey<Q, K, H>
+  const V *find(const Q &key) const
+  {
+    return this->find_key(key);
+  }
+
+  std::optional<V> get(K key) override final
+  {
+    const V *value = this->find(key);
+    if (!value) return std::nullopt;
+    return *value;
+  }
+
+  /**
+   * Looks every key from `keys` up, writing its value (or `nullopt`) to the
+   * same position of `values`.
+   *
+   * Rather than waiting on each lookup's cache miss before issuing the next,
+   * every key is hashed up front and the rows of the key `prefetch_distance`
+   * positions ahead are prefetched while the current one is resolved.
+   */
+  void get_batch(std::span<const K> keys, std::span<std::optional<V>> values,
+                 size_t prefetch_distance = 16) const noexcept(false)
+  {
+    if (values.size() < keys.size())
+    {
+      throw std::invalid_argument("There must be a value for each key");
+    }
+
+    this->for_each_hashed(
+        keys, prefetch_distance,
+        [&](size_t i, Sequence sequence)
+        {
+          auto internal_index =
+              this->find_internal_index_of(keys[i], sequence);
+          if (!internal_index.has_value())
+          {
+            values[i] = std::nullopt;
+            return;
+          }
+          values[i] = this->internal_list[*internal_index].element->second;
+        });
+  }
+
+  /**
+   * Inserts — or replaces — every key from `keys` with the value at the same
+   * position of `values`, prefetching rows just like `get_batch` does.
+   */
+  void insert_batch(std::span<const K> keys, std::span<const V> values,
+                    size_t prefetch_distance = 16) noexcept(false)
+  {
+    if (values.size() < keys.size())
+    {
+      throw std::invalid_argument("There must be a value for each key");
+    }
+
+    // probing sequences are only valid as long as the table doesn't resize,
+    // so room is made for the whole batch beforehand. Like `maybe_resize`
+    // does, it keeps the elements and tombstones to at most half the rows,
+    // purging the tombstones if growing isn't enough or isn't allowed.
+    const auto count = this->_size + keys.size();
+    this->reserve(count);
+    if (this->tombstones &&
+        count + this->tombstones > this->internal_list_size / 2.0)
+    {
+      this->purge_tombstones();
+    }
+
+    this->for_each_hashed(
+        keys, prefetch_distance,
+        [&](size_t i, Sequence sequence)
+        {
+          auto [row, is_insertion] =
+              this->find_placement_for(keys[i], sequence);
+          if (is_insertion)
+          {
+            if (row->is_deleted()) this->tombstones--;
+            row->set_element(keys[i], values[i]);
+            this->_size++;
+            return;
+          }
+          row->element->second = values[i];
+        });
   }
 
   void remove(K key) override final
@@ -217,6 +840,8 @@ public:
     {
       row.soft_delete();
       this->_size--;
+      this->tombstones++;
+      this->maybe_shrink();
     }
   }
 };
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+
+namespace core::hash_table
+{
+
+/*
+ * Probing policies of `OAHashTable`. A policy's `Sequence` yields the rows a
+ * key may live at, starting from the key's hash. Insertions, lookups and
+ * removals walk the very same sequence, and removals leave tombstones behind
+ * rather than moving keys, so a key is always found before the first free row
+ * of its sequence. Every sequence visits each row exactly once within its
+ * first `capacity` rows, thus a table with any non-occupied row always has
+ * room for one more key.
+ */
+
+namespace internal
+{
+
+/**
+ * The home row of `hash` in a table of `mask + 1` rows, a power of two.
+ * Fibonacci hashing leaves the well mixed bits at the top of the product.
+ */
+inline size_t fibonacci_home_of(size_t hash, size_t mask)
+{
+  if (mask == 0) return 0;
+  return (hash * 0x9E3779B97F4A7C15ull) >> std::countl_zero(mask);
+}
+
+} // namespace internal
+
+/**
+ * Probes the rows following the key's hash, one by one. Keys sharing a
+ * cluster sit next to each other, so most probes stay within a cache line,
+ * but clusters merge and grow quickly as the table fills.
+ */
+struct LinearProbing
+{
+  static constexpr uint32_t id = 0;
+  static constexpr bool power_of_two_capacity = false;
+
+  class Sequence
+  {
+  private:
+    size_t _row;
+    size_t capacity;
+
+  public:
+    Sequence() = default;
+
+    Sequence(size_t hash, size_t capacity)
+        : _row(hash % capacity), capacity(capacity)
+    {
+    }
+
+    size_t row() const { return this->_row; }
+
+    void next()
+    {
+      this->_row++;
+      if (this->_row == this->capacity) this->_row = 0;
+    }
+  };
+};
+
+/**
+ * Probes rows at triangular distances from the key's hash: 0, 1, 3, 6, 10...
+ * Keys whose hashes differ part ways at once, which avoids primary
+ * clustering while the first few probes still stay close by.
+ *
+ * Triangular numbers only cover every row of power of two tables, so
+ * capacities are rounded up to one.
+ */
+struct QuadraticProbing
+{
+  static constexpr uint32_t id = 1;
+  static constexpr bool power_of_two_capacity = true;
+
+  class Sequence
+  {
+  private:
+    size_t _row;
+    size_t mask;
+    size_t step;
+
+  public:
+    Sequence() = default;
+
+    Sequence(size_t hash, size_t capacity)
+        : _row(internal::fibonacci_home_of(hash, capacity - 1)),
+          mask(capacity - 1), step(0)
+    {
+    }
+
+    size_t row() const { return this->_row; }
+
+    void next()
+    {
+      this->step++;
+      this->_row = (this->_row + this->step) & this->mask;
+    }
+  };
+};
+
+/**
+ * Probes rows at a fixed stride derived from a second hash of the key, so that
+ * even keys sharing a home row take different paths. It avoids both primary
+ * and secondary clustering, at the cost of nearly every probe missing the
+ * cache.
+ *
+ * An odd stride only covers every row of power of two tables, so capacities
+ * are rounded up to one.
+ */
+struct DoubleHashing
+{
+  static constexpr uint32_t id = 2;
+  static constexpr bool power_of_two_capacity = true;
+
+  class Sequence
+  {
+  private:
+    size_t _row;
+    size_t mask;
+    size_t stride;
+
+  public:
+    Sequence() = default;
+
+    Sequence(size_t hash, size_t capacity)
+        : _row(internal::fibonacci_home_of(hash, capacity - 1)),
+          mask(capacity - 1),
+          stride((std::rotl(hash * 0xC2B2AE3D27D4EB4Full, 32) | 1) &
+                 (capacity - 1))
+    {
+    }
+
+    size_t row() const { return this->_row; }
+
+    void next() { this->_row = (this->_row + this->stride) & this->mask; }
+  };
+};
+
+/**
+ * What `OAHashTable` requires from a probing policy: an `id` that tells it
+ * apart in snapshots, whether it needs power of two capacities, and its
+ * `Sequence`.
+ */
+template <typename P>
+concept ProbingPolicy =
+    std::same_as<decltype(P::id), const uint32_t> &&
+    std::same_as<decltype(P::power_of_two_capacity), const bool> &&
+    std::default_initializable<typename P::Sequence> &&
+    std::constructible_from<typename P::Sequence, size_t, size_t> &&
+    requires(typename P::Sequence sequence) {
+      { sequence.row() } -> std::convertible_to<size_t>;
+      sequence.next();
+    };
+
+} // namespace core::hash_table
@@ -1,74 +1,376 @@
 #pragma once
 
+#include "hash_table.hpp"
 #include <algorithm>
-#include <list>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
 #include <memory>
 #include <optional>
+#include <stdexcept>
 #include <stdlib.h>
 #include <string>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 namespace core::hash_table
 {
 
-template <typename V, typename K = size_t> class SCHashTable
+/**
+ * A separate chaining hash table whose nodes live in a single contiguous pool
+ * and are chained by their indices within it, rather than each being a
+ * separate heap allocation.
+ *
+ * The pool is kept dense: removing a node moves the last one into its place.
+ * Thus, pointers returned by `find` and friends are only valid until the next
+ * insertion or removal.
+ */
+template <typename V, typename K = size_t, typename H = Hash<K>>
+class SCHashTable
 {
 private:
+  static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+  struct Node
+  {
+    std::pair<K, V> element;
+    uint32_t next;
+
+    template <typename KK, typename... Args>
+    Node(KK &&key, uint32_t next, Args &&...args)
+        : element(std::piecewise_construct,
+                  std::forward_as_tuple(std::forward<KK>(key)),
+                  std::forward_as_tuple(std::forward<Args>(args)...)),
+          next(next)
+    {
+    }
+  };
+
   size_t table_size;
-  size_t _size;
-  std::unique_ptr<std::list<std::pair<K, V>>[]> internal_list;
+  float _max_load_factor;
+  std::vector<Node> nodes;
+  /// The index of each bucket's first node, or `npos` if it's empty.
+  std::unique_ptr<uint32_t[]> buckets;
+  size_t rehash_count;
+  std::chrono::nanoseconds rehash_duration;
+  [[no_unique_address]] mutable internal::ProbeCounters probe_counters;
 
-  size_t hash(K key) { return key % this->table_size; }
+  template <typename Q> size_t hash(const Q &key) const
+  {
+    return H{}(key) % this->table_size;
+  }
+
+  template <typename Q> uint32_t find_node_of(const Q &key) const
+  {
+    auto index = this->buckets[this->hash(key)];
+    size_t probes = 0;
+
+    while (index != npos && !(this->nodes[index].element.first == key))
+    {
+      index = this->nodes[index].next;
+      probes++;
+    }
+
+    this->probe_counters.count(index == npos ? probes : probes + 1);
+    return index;
+  }
+
+  template <typename Q> V *find_key(const Q &key) const
+  {
+    const auto index = this->find_node_of(key);
+    if (index == npos) return nullptr;
+    return const_cast<V *>(&this->nodes[index].element.second);
+  }
+
+  /**
+   * Finds the link — either a bucket head or some node's `next` — that points
+   * to the node at `index`.
+   */
+  uint32_t &link_to(uint32_t index)
+  {
+    const auto hash = this->hash(this->nodes[index].element.first);
+    uint32_t *link = &this->buckets[hash];
+    while (*link != index) link = &this->nodes[*link].next;
+    return *link;
+  }
+
+  void maybe_rehash()
+  {
+    const auto threshold = this->table_size * this->_max_load_factor;
+    if (this->nodes.size() <= threshold) return;
+    this->rehash(this->table_size * 2);
+  }
+
+  template <typename KK, typename... Args>
+  std::pair<V *, bool> try_emplace_key(KK &&key, Args &&...args)
+  {
+    const auto existing = this->find_node_of(key);
+    if (existing != npos)
+    {
+      return std::pair(&this->nodes[existing].element.second, false);
+    }
+
+    if (this->nodes.size() == npos)
+    {
+      throw std::runtime_error("Hash table is full");
+    }
+
+    const auto hash = this->hash(key);
+    const auto index = (uint32_t)this->nodes.size();
+    this->nodes.emplace_back(std::forward<KK>(key), this->buckets[hash],
+                             std::forward<Args>(args)...);
+    this->buckets[hash] = index;
+
+    this->maybe_rehash();
+    return std::pair(&this->nodes[index].element.second, true);
+  }
+
+  template <typename KK, typename M>
+  std::pair<V *, bool> insert_or_assign_key(KK &&key, M &&value)
+  {
+    auto [value_ptr, is_insertion] =
+        this->try_emplace_key(std::forward<KK>(key), std::forward<M>(value));
+    if (!is_insertion) *value_ptr = std::forward<M>(value);
+    return std::pair(value_ptr, is_insertion);
+  }
 
 public:
-  SCHashTable(size_t initial_size) : table_size(initial_size), _size(0)
+  /**
+   * Walks over every key-value pair in the table. Since nodes are densely
+   * pooled, it's a plain sequential scan. Keys may not be changed through it,
+   * thus it's always constant.
+   */
+  class Iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::pair<K, V>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type *;
+    using reference = const value_type &;
+
+    Iterator() : node(nullptr) {}
+    Iterator(const Node *node) : node(node) {}
+
+    reference operator*() const { return this->node->element; }
+    pointer operator->() const { return &this->node->element; }
+
+    Iterator &operator++()
+    {
+      this->node++;
+      return *this;
+    }
+
+    Iterator operator++(int)
+    {
+      auto previous = *this;
+      this->node++;
+      return previous;
+    }
+
+    bool operator==(const Iterator &other) const = default;
+
+  private:
+    const Node *node;
+  };
+
+  using iterator = Iterator;
+  using const_iterator = Iterator;
+
+  SCHashTable(size_t initial_size)
+      : table_size(std::max<size_t>(initial_size, 1)), _max_load_factor(1.0),
+        rehash_count(0), rehash_duration(0)
   {
+    this->buckets = std::make_unique<uint32_t[]>(this->table_size);
+    std::fill_n(this->buckets.get(), this->table_size, npos);
+  }
 
-    this->internal_list =
-        std::make_unique<std::list<std::pair<K, V>>[]>(initial_size);
+  Iterator begin() const { return Iterator(this->nodes.data()); }
+
+  Iterator end() const
+  {
+    return Iterator(this->nodes.data() + this->nodes.size());
   }
 
-  virtual size_t size() const { return this->_size; }
+  virtual size_t size() const { return this->nodes.size(); }
+  size_t bucket_count() const { return this->table_size; }
 
-  void insert(K key, V value)
+  float load_factor() const
   {
-    auto hash = this->hash(key);
-    std::list<std::pair<K, V>> &bucket = this->internal_list[hash];
-    auto pair_it =
-        std::find_if(bucket.begin(), bucket.end(),
-                     [&key](const auto &pair) { return pair.first == key; });
+    return (float)this->nodes.size() / (float)this->table_size;
+  }
+
+  float max_load_factor() const { return this->_max_load_factor; }
 
-    if (pair_it != bucket.end())
+  /**
+   * Scans every bucket to report how the keys are spread. A key's probe
+   * length is its position within its bucket's chain.
+   */
+  HashTableStats stats() const
+  {
+    auto stats = HashTableStats{};
+    stats.size = this->nodes.size();
+    stats.capacity = this->table_size;
+    stats.load_factor = this->load_factor();
+    stats.tombstone_ratio = 0;
+    stats.resize_count = this->rehash_count;
+    stats.resize_duration = this->rehash_duration;
+    this->probe_counters.report(stats);
+
+    for (size_t bucket = 0; bucket < this->table_size; bucket++)
     {
-      (*pair_it).second = value;
-      return;
+      size_t chain_length = 0;
+      for (auto index = this->buckets[bucket]; index != npos;
+           index = this->nodes[index].next)
+      {
+        chain_length++;
+        if (stats.probe_histogram.size() <= chain_length)
+        {
+          stats.probe_histogram.resize(chain_length + 1, 0);
+        }
+        stats.probe_histogram[chain_length]++;
+      }
+      stats.longest_cluster = std::max(stats.longest_cluster, chain_length);
     }
 
-    bucket.push_back(std::pair(key, value));
-    this->_size++;
+    internal::summarize_probes(stats);
+    return stats;
   }
 
-  std::optional<V> get(K key)
+  /**
+   * Sets the load factor above which the table doubles its buckets count,
+   * throwing a `std::invalid_argument` unless it's positive and finite.
+   */
+  void max_load_factor(float max_load_factor) noexcept(false)
   {
-    auto h = this->hash(key);
+    if (!(max_load_factor > 0) || !std::isfinite(max_load_factor))
+    {
+      throw std::invalid_argument(
+          "The max load factor must be positive and finite");
+    }
 
-    std::list<std::pair<K, V>> &bucket = this->internal_list[h];
-    auto value_iterator = std::find_if(bucket.begin(), bucket.end(),
-                                       [&key](const std::pair<K, V> &pair)
-                                       { return pair.first == key; });
+    this->_max_load_factor = max_load_factor;
+    this->maybe_rehash();
+  }
 
-    if (value_iterator == bucket.end()) return std::nullopt;
-    return (*value_iterator).second;
+  /**
+   * Redistributes the nodes over `buckets_count` buckets. Nodes are only
+   * relinked, never moved nor reallocated.
+   */
+  void rehash(size_t buckets_count)
+  {
+    const auto timer = internal::ScopedTimer(this->rehash_duration);
+    this->rehash_count++;
+
+    this->table_size = std::max<size_t>(buckets_count, 1);
+    this->buckets = std::make_unique<uint32_t[]>(this->table_size);
+    std::fill_n(this->buckets.get(), this->table_size, npos);
+
+    for (uint32_t index = 0; index < this->nodes.size(); index++)
+    {
+      Node &node = this->nodes[index];
+      const auto hash = this->hash(node.element.first);
+      node.next = this->buckets[hash];
+      this->buckets[hash] = index;
+    }
+  }
+
+  void insert(K key, V value)
+  {
+    this->insert_or_assign(std::move(key), std::move(value));
+  }
+
+  /**
+   * Inserts `key` with a value constructed in place from `args`, unless the
+   * key is already present, in which case nothing is constructed nor moved.
+   *
+   * @returns A pointer to the key's value and whether an insertion happened.
+   */
+  template <typename... Args>
+  std::pair<V *, bool> try_emplace(const K &key, Args &&...args)
+  {
+    return this->try_emplace_key(key, std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  std::pair<V *, bool> try_emplace(K &&key, Args &&...args)
+  {
+    return this->try_emplace_key(std::move(key), std::forward<Args>(args)...);
+  }
+
+  /**
+   * Inserts `key` with `value`, or assigns `value` to the key's current value
+   * if it is already present.
+   *
+   * @returns A pointer to the key's value and whether an insertion happened.
+   */
+  template <typename M>
+  std::pair<V *, bool> insert_or_assign(const K &key, M &&value)
+  {
+    return this->insert_or_assign_key(key, std::forward<M>(value));
+  }
+
+  template <typename M>
+  std::pair<V *, bool> insert_or_assign(K &&key, M &&value)
+  {
+    return this->insert_or_assign_key(std::move(key), std::forward<M>(value));
+  }
+
+  /**
+   * Looks `key` up without copying its value.
+   *
+   * @returns A pointer to the key's value, that is valid until the next
+   * insertion or removal, or `nullptr` if the key is not in the table.
+   */
+  V *find(const K &key) { return this->find_key(key); }
+  const V *find(const K &key) const { return this->find_key(key); }
+
+  /**
+   * Looks up a key equal to `key` without building a `K` from it.
+   */
+  template <typename Q>
+    requires internal::HeterogeneousKey<Q, K, H>
+  V *find(const Q &key)
+  {
+    return this->find_key(key);
+  }
+
+  template <typename Q>
+    requires internal::HeterogeneousKey<Q, K, H>
+  const V *find(const Q &key) const
+  {
+    return this->find_key(key);
+  }
+
+  std::optional<V> get(K key)
+  {
+    const V *value = this->find(key);
+    if (!value) return std::nullopt;
+    return *value;
   }
 
   void remove(K key)
   {
-    auto hash = this->hash(key);
-    std::list<std::pair<K, V>> &bucket = this->internal_list[hash];
-    const auto removed_elements = bucket.remove_if(
-        [&key](const auto &value) { return value.first == key; });
+    const auto index = this->find_node_of(key);
+    if (index == npos) return;
+
+    uint32_t &link = this->link_to(index);
+    link = this->nodes[index].next;
+
+    // keeps the pool dense by moving the last node into the removed one's
+    // place.
+    const auto last = (uint32_t)this->nodes.size() - 1;
+    if (index != last)
+    {
+      this->link_to(last) = index;
+      this->nodes[index] = std::move(this->nodes[last]);
+    }
 
-    this->_size -= removed_elements;
+    this->nodes.pop_back();
   }
 };
 
@@ -0,0 +1,209 @@
+#pragma once
+
+#include "hash_table.hpp"
+#include "hash_table/probing.hpp"
+#include "utils/mapped_file.hpp"
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace core::hash_table
+{
+
+namespace internal
+{
+
+/**
+ * The first bytes of a hash table snapshot file. Snapshots are written in the
+ * machine's own byte order and types layout, so they may only be read back on
+ * the same architecture.
+ */
+struct SnapshotHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t key_size;
+  uint32_t value_size;
+  uint32_t row_size;
+  /// The `id` of the table's probing policy.
+  uint32_t probing;
+  uint32_t reserved;
+  uint64_t capacity;
+  uint64_t size;
+  /// Where the rows begin, counting from the start of the file.
+  uint64_t rows_offset;
+  /// The checksum of every byte of the rows.
+  uint64_t checksum;
+};
+
+constexpr char snapshot_magic[8] = {'A', 'E', 'D', '2', 'H', 'T', 'S', 'N'};
+constexpr uint32_t snapshot_version = 2;
+constexpr uint64_t snapshot_rows_alignment = 64;
+
+/**
+ * A table row as laid out in the snapshot.
+ */
+template <typename K, typename V> struct SnapshotRow
+{
+  K key;
+  V value;
+  State state;
+};
+
+/**
+ * Continues the checksum `state` over `bytes`. It's FNV-1a, but digesting
+ * eight bytes at a time so that it keeps up with the disk.
+ */
+inline uint64_t checksum(std::span<const std::byte> bytes,
+                         uint64_t state = 0xCBF29CE484222325ull)
+{
+  constexpr uint64_t prime = 0x100000001B3ull;
+
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= bytes.size(); i += sizeof(uint64_t))
+  {
+    uint64_t word;
+    std::memcpy(&word, bytes.data() + i, sizeof(word));
+    state = (state ^ word) * prime;
+  }
+
+  for (; i < bytes.size(); i++)
+  {
+    state = (state ^ static_cast<uint64_t>(bytes[i])) * prime;
+  }
+
+  return state;
+}
+
+} // namespace internal
+
+/**
+ * A read-only `OAHashTable` served straight from a snapshot file mapped into
+ * memory: opening it doesn't read nor deserialize a thing, and the pages it
+ * touches are shared with every other process that maps the same snapshot.
+ *
+ * The snapshot must have been saved by an `OAHashTable` with the same `V`, `K`,
+ * `H` and `Probing`.
+ */
+template <typename V, typename K = size_t, typename H = Hash<K>,
+          ProbingPolicy Probing = LinearProbing>
+class MappedOAHashTable
+{
+  static_assert(std::is_trivially_copyable_v<K> &&
+                    std::is_trivially_copyable_v<V>,
+                "Only trivially copyable keys and values can be mapped.");
+
+private:
+  using Row = internal::SnapshotRow<K, V>;
+
+  utils::MappedFile file;
+  const Row *rows;
+  size_t _size;
+  size_t _capacity;
+
+  static std::runtime_error invalid(const std::string &reason)
+  {
+    return std::runtime_error("Invalid hash table snapshot: " + reason);
+  }
+
+public:
+  /**
+   * Maps the snapshot at `path`, validating its header.
+   *
+   * @param verify_checksum Whether to also check every row against the
+   * snapshot's checksum. It requires reading the whole file, so it's off by
+   * default.
+   */
+  MappedOAHashTable(const std::string &path,
+                    bool verify_checksum = false) noexcept(false)
+      : file(path)
+  {
+    using namespace internal;
+
+    const auto bytes = this->file.bytes();
+    if (bytes.size() < sizeof(SnapshotHeader)) throw invalid("too short");
+
+    SnapshotHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, snapshot_magic, sizeof(snapshot_magic)))
+    {
+      throw invalid("not a snapshot");
+    }
+    if (header.version != snapshot_version)
+    {
+      throw invalid("unsupported version " + std::to_string(header.version));
+    }
+    if (header.key_size != sizeof(K) || header.value_size != sizeof(V) ||
+        header.row_size != sizeof(Row))
+    {
+      throw invalid("keys or values types don't match");
+    }
+    if (header.probing != Probing::id)
+    {
+      throw invalid("probing policies don't match");
+    }
+    if (header.capacity == 0 || header.size > header.capacity ||
+        header.rows_offset % alignof(Row) != 0 ||
+        header.rows_offset > bytes.size() ||
+        (bytes.size() - header.rows_offset) / sizeof(Row) < header.capacity)
+    {
+      throw invalid("corrupted header");
+    }
+
+    const auto rows_bytes =
+        bytes.subspan(header.rows_offset, header.capacity * sizeof(Row));
+    if (verify_checksum && checksum(rows_bytes) != header.checksum)
+    {
+      throw invalid("checksum mismatch");
+    }
+
+    this->rows = reinterpret_cast<const Row *>(rows_bytes.data());
+    this->_size = header.size;
+    this->_capacity = header.capacity;
+  }
+
+  size_t size() const { return this->_size; }
+  size_t capacity() const { return this->_capacity; }
+
+  /**
+   * Looks `key` up, exactly as the `OAHashTable` that saved the snapshot
+   * would.
+   *
+   * @returns A pointer to the key's value within the mapping, or `nullptr`
+   * if the key is not in the table.
+   */
+  const V *find(const K &key) const
+  {
+    using namespace internal;
+    auto sequence = typename Probing::Sequence(H{}(key), this->_capacity);
+
+    for (size_t steps = 0; steps < this->_capacity; steps++)
+    {
+      const Row &row = this->rows[sequence.row()];
+
+      if (row.state == State::Free) break;
+      if (row.state == State::Occupied && row.key == key)
+      {
+        return &row.value;
+      }
+      sequence.next();
+    }
+
+    return nullptr;
+  }
+
+  std::optional<V> get(K key) const
+  {
+    const V *value = this->find(key);
+    if (!value) return std::nullopt;
+    return *value;
+  }
+};
+
+} // namespace core::hash_table
@@ -14,16 +14,19 @@ namespace internal
 template <typename T> void shift_right(T *first, T *last, size_t steps)
 {
   const size_t size = last - first;
-  if (!steps || size <= steps) return;
+  if (!steps || size < steps) return;
 
   T *target = last - steps;
 
-  while (target >= first)
+  // stops at `first` rather than past it, as pointing before an array is
+  // undefined.
+  while (target != first)
   {
     *last = *target;
     last--;
     target--;
   }
+  *last = *target;
 }
 
 } // namespace internal
@@ -38,8 +41,10 @@ template <typename T> void insertion_sort(std::span<T> vec)
     const auto current_element = vec[current_element_pos];
 
     size_t first_smaller_element = current_element_pos - 1;
+    // stops at equal elements too, which keeps them in order and doesn't
+    // walk back over long runs of them.
     while (first_smaller_element != 0 &&
-           vec[first_smaller_element] >= current_element)
+           vec[first_smaller_element] > current_element)
     {
       first_smaller_element--;
     }
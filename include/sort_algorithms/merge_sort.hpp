@@ -161,13 +161,13 @@ void merge(T *subvector, const size_t first_element_pos,
 
   interleave(InterleaveArgs<T>{
       .target_vector = subvector,
-      .vector_central_element_pos = central_element_pos,
-      .vector_first_element_pos = first_element_pos,
-      .vector_last_element_pos = last_element_pos,
+      .right_subvec = std::move(right_subvec),
       .left_subvec = std::move(left_subvec),
       .left_subvector_size = left_subvector_size,
-      .right_subvec = std::move(right_subvec),
       .right_subvector_size = right_subvector_size,
+      .vector_first_element_pos = first_element_pos,
+      .vector_last_element_pos = last_element_pos,
+      .vector_central_element_pos = central_element_pos,
       .meta = meta,
   });
 }
@@ -205,6 +205,8 @@ internal::MergeSortResultMetadata merge_sort(std::span<T> vector)
 {
   using namespace internal;
   auto metadata = MergeSortResultMetadata{.inversions_count = 0};
+  if (vector.empty()) return metadata;
+
   merge_sort(vector, 0, vector.size() - 1, &metadata);
   return metadata;
 }
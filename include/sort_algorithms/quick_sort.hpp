@@ -2,6 +2,9 @@
 
 #include "sort_algorithms/insertion_sort.hpp"
 #include "sort_algorithms/utils.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
 #include <span>
 
 namespace core::sort_algorithms::internal
@@ -77,6 +80,27 @@ template <typename T> size_t partition(std::span<T> vec, size_t pivot_pos)
   return border_cursor;
 }
 
+/**
+ * Moves every element from `vec` smaller than `pivot` before the others.
+ *
+ * @returns How many elements are smaller than `pivot`.
+ */
+template <typename T> size_t partition_smaller(std::span<T> vec, const T pivot)
+{
+  size_t border_cursor = 0;
+
+  for (size_t current_el_cursor = 0; current_el_cursor < vec.size();
+       current_el_cursor++)
+  {
+    if (!(vec[current_el_cursor] < pivot)) continue;
+
+    internal::swap(vec, current_el_cursor, border_cursor);
+    border_cursor++;
+  }
+
+  return border_cursor;
+}
+
 typedef struct
 {
   size_t offset;
@@ -95,8 +119,8 @@ QuickSortSubvectorsRanges calculate_subvectors(size_t vec_size,
   auto left_range = QuickSortSubvectorRange{.offset = 0, .count = pivot_pos};
 
   auto right_range = QuickSortSubvectorRange{
-      .count = 0,
       .offset = pivot_pos + 1,
+      .count = 0,
   };
 
   right_range.count = vec_size - right_range.offset;
@@ -109,24 +133,57 @@ QuickSortSubvectorsRanges calculate_subvectors(size_t vec_size,
 namespace core::sort_algorithms
 {
 
+/**
+ * @param bounded Whether the element right after `vec` is a pivot, thus not
+ * smaller than any of `vec`'s elements.
+ */
 template <typename T>
-void quick_sort(std::span<T> vec, size_t pivot_pos, uint8_t threshold)
+void quick_sort(std::span<T> vec, size_t pivot_pos, uint8_t threshold,
+                bool bounded = false)
 {
   using namespace internal;
 
-  if (vec.size() <= threshold) return;
-
-  pivot_pos = partition(vec, pivot_pos);
-
-  auto subvecs = calculate_subvectors(vec.size(), pivot_pos);
-
-  auto left_subvec = vec.subspan(subvecs.left.offset, subvecs.left.count);
-  const auto left_subvec_pivot = get_pivot(left_subvec);
-  quick_sort(left_subvec, left_subvec_pivot, threshold);
+  const auto sort_subvector = [&](std::span<T> subvec, bool subvec_bounded)
+  {
+    if (subvec.size() <= threshold) return;
+    quick_sort(subvec, get_pivot(subvec), threshold, subvec_bounded);
+  };
 
-  auto right_subvec = vec.subspan(subvecs.right.offset, subvecs.right.count);
-  const auto right_subvec_pivot = get_pivot(right_subvec);
-  quick_sort(right_subvec, right_subvec_pivot, threshold);
+  // only the smaller side is sorted recursively, and the larger one by the
+  // loop, so that the stack stays logarithmic however unbalanced they are.
+  while (vec.size() > threshold)
+  {
+    if (bounded && !(vec[pivot_pos] < vec.data()[vec.size()]))
+    {
+      // the pivot equals the bound, so the elements equal to it are already
+      // in place once the smaller ones are moved before them. Otherwise,
+      // repeated elements would take quadratic time.
+      vec = vec.first(partition_smaller(vec, vec[pivot_pos]));
+    }
+    else
+    {
+      pivot_pos = partition(vec, pivot_pos);
+
+      auto subvecs = calculate_subvectors(vec.size(), pivot_pos);
+      auto left_subvec = vec.subspan(subvecs.left.offset, subvecs.left.count);
+      auto right_subvec =
+          vec.subspan(subvecs.right.offset, subvecs.right.count);
+
+      if (left_subvec.size() < right_subvec.size())
+      {
+        sort_subvector(left_subvec, true);
+        vec = right_subvec;
+      }
+      else
+      {
+        sort_subvector(right_subvec, bounded);
+        vec = left_subvec;
+        bounded = true;
+      }
+    }
+
+    if (vec.size() > threshold) pivot_pos = get_pivot(vec);
+  }
 }
 
 template <typename T> void quick_sort(std::span<T> vec, uint8_t threshold = 15)
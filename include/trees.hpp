@@ -1,3 +1,8 @@
 #pragma once
 
+#include "trees/b_plus_tree.hpp"
 #include "trees/binary_search_tree.hpp"
+#include "trees/eytzinger_tree.hpp"
+#include "trees/node_pool.hpp"
+#include "trees/persistent_tree.hpp"
+#include "trees/skip_list.hpp"
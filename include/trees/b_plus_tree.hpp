@@ -0,0 +1,769 @@
+#pragma once
+
+#include "trees/node_pool.hpp"
+#include "trees/node_search.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace core::trees
+{
+
+/**
+ * An ordered map whose nodes hold many keys each, about `NodeBytes` worth of
+ * them, so that a lookup misses the cache once per level of a very shallow
+ * tree rather than once per level of a binary one.
+ *
+ * Values are only kept in the leaves, which are linked in key order, so that
+ * scanning a range walks leaves one after another without going back up.
+ * Inner nodes only route: each key of theirs is not greater than any key of
+ * the child to its right.
+ *
+ * Nodes are searched with `internal::count_compared`. Arithmetic keys past a
+ * node's count are padded with the greatest value, or infinity, so that every
+ * key of the node can be compared at once. Other keys are bisected. Keys and
+ * values must be default constructible, and floating-point keys must not be
+ * NaN.
+ */
+template <typename K, typename V, size_t NodeBytes = 512> class BPlusTree
+{
+private:
+  static constexpr uint32_t none = NodePool<K>::none;
+  static constexpr bool padded = std::is_arithmetic_v<K>;
+
+  /// Capacities are multiples of 4, as `internal::count_compared` requires.
+  static constexpr uint32_t leaf_capacity = std::max<uint32_t>(
+      (NodeBytes - 8) / (sizeof(K) + sizeof(V)) / 4 * 4, 4);
+  static constexpr uint32_t inner_capacity =
+      std::max<uint32_t>((NodeBytes - 8) / (sizeof(K) + 4) / 4 * 4, 4);
+
+  /// Nodes with fewer keys than this are merged with, or fed by, a sibling.
+  static constexpr uint32_t min_leaf_count = leaf_capacity / 4;
+  static constexpr uint32_t min_inner_count = inner_capacity / 4;
+
+  struct alignas(64) Leaf
+  {
+    uint32_t count;
+    /// The next leaf in key order, or `none` for the last one.
+    uint32_t next;
+    K keys[leaf_capacity];
+    V values[leaf_capacity];
+
+    Leaf() : count(0), next(none) { pad(this->keys, 0, leaf_capacity); }
+  };
+
+  struct alignas(64) Inner
+  {
+    uint32_t count;
+    K keys[inner_capacity];
+    /// Children, one more than keys. They're leaves on the last inner level.
+    uint32_t children[inner_capacity + 1];
+
+    Inner() : count(0) { pad(this->keys, 0, inner_capacity); }
+  };
+
+  /// A step down from an inner node, to its `child`-th child.
+  struct Step
+  {
+    uint32_t node;
+    uint32_t child;
+  };
+
+  NodePool<Leaf> leaves;
+  NodePool<Inner> inners;
+  uint32_t root;
+  /// How many levels there are, leaves included. Zero if the tree is empty.
+  uint32_t levels;
+  uint32_t first_leaf;
+  size_t _size;
+  /// The inner nodes the last insertion or removal went through, kept to
+  /// avoid allocating it each time.
+  std::vector<Step> path;
+
+  static void pad(K *keys, uint32_t from, uint32_t to)
+  {
+    if constexpr (std::is_floating_point_v<K>)
+    {
+      // no key may be greater than the padding, infinities included.
+      std::fill(keys + from, keys + to, std::numeric_limits<K>::infinity());
+    }
+    else if constexpr (padded)
+    {
+      std::fill(keys + from, keys + to, std::numeric_limits<K>::max());
+    }
+  }
+
+  /**
+   * The position of the first key of `leaf` not less than `key`.
+   */
+  static uint32_t position_in(const Leaf &leaf, const K &key)
+  {
+    if constexpr (padded)
+    {
+      return (uint32_t)internal::count_compared<false>(leaf.keys,
+                                                       leaf_capacity, key);
+    }
+    else
+    {
+      return (uint32_t)(std::lower_bound(leaf.keys, leaf.keys + leaf.count,
+                                         key) -
+                        leaf.keys);
+    }
+  }
+
+  /**
+   * The position of the child of `inner` whose subtree may hold `key`,
+   * which is how many of its keys are not greater than `key`.
+   */
+  static uint32_t child_of(const Inner &inner, const K &key)
+  {
+    if constexpr (padded)
+    {
+      const auto greater =
+          internal::count_compared<true>(inner.keys, inner_capacity, key);
+      // the padding is not greater than the greatest key.
+      return std::min((uint32_t)(inner_capacity - greater), inner.count);
+    }
+    else
+    {
+      return (uint32_t)(std::upper_bound(inner.keys,
+                                         inner.keys + inner.count, key) -
+                        inner.keys);
+    }
+  }
+
+  uint32_t find_leaf(const K &key) const
+  {
+    auto node = this->root;
+    for (auto level = this->levels; level > 1; level--)
+    {
+      const Inner &inner = this->inners[node];
+      node = inner.children[child_of(inner, key)];
+    }
+    return node;
+  }
+
+  /**
+   * Finds the leaf that may hold `key`, recording the way down in `path`.
+   */
+  uint32_t find_leaf_recording(const K &key)
+  {
+    this->path.clear();
+    auto node = this->root;
+
+    for (auto level = this->levels; level > 1; level--)
+    {
+      const Inner &inner = this->inners[node];
+      const auto child = child_of(inner, key);
+      this->path.push_back(Step{node, child});
+      node = inner.children[child];
+    }
+    return node;
+  }
+
+  /**
+   * Inserts `separator` and its right child `right` into the inner nodes of
+   * `path`, from the deepest one up, splitting the full ones on the way.
+   */
+  void insert_into_parents(K separator, uint32_t right)
+  {
+    for (auto step = this->path.size(); step-- > 0;)
+    {
+      const auto [index, child] = this->path[step];
+      Inner &inner = this->inners[index];
+
+      if (inner.count < inner_capacity)
+      {
+        std::move_backward(inner.keys + child, inner.keys + inner.count,
+                           inner.keys + inner.count + 1);
+        std::move_backward(inner.children + child + 1,
+                           inner.children + inner.count + 1,
+                           inner.children + inner.count + 2);
+        inner.keys[child] = std::move(separator);
+        inner.children[child + 1] = right;
+        inner.count++;
+        return;
+      }
+
+      // lays the keys and children out as if the node could fit them, then
+      // splits them around the middle key, which moves up.
+      std::array<K, inner_capacity + 1> keys;
+      std::array<uint32_t, inner_capacity + 2> children;
+      std::move(inner.keys, inner.keys + child, keys.begin());
+      keys[child] = std::move(separator);
+      std::move(inner.keys + child, inner.keys + inner_capacity,
+                keys.begin() + child + 1);
+      std::copy(inner.children, inner.children + child + 1,
+                children.begin());
+      children[child + 1] = right;
+      std::copy(inner.children + child + 1,
+                inner.children + inner_capacity + 1,
+                children.begin() + child + 2);
+
+      const auto middle = (inner_capacity + 1) / 2;
+      const auto sibling_index = this->inners.allocate();
+      Inner &sibling = this->inners[sibling_index];
+
+      std::move(keys.begin(), keys.begin() + middle, inner.keys);
+      std::copy(children.begin(), children.begin() + middle + 1,
+                inner.children);
+      inner.count = middle;
+      pad(inner.keys, middle, inner_capacity);
+
+      std::move(keys.begin() + middle + 1, keys.end(), sibling.keys);
+      std::copy(children.begin() + middle + 1, children.end(),
+                sibling.children);
+      sibling.count = inner_capacity - middle;
+
+      separator = std::move(keys[middle]);
+      right = sibling_index;
+    }
+
+    const auto new_root = this->inners.allocate();
+    Inner &inner = this->inners[new_root];
+    inner.keys[0] = std::move(separator);
+    inner.children[0] = this->root;
+    inner.children[1] = right;
+    inner.count = 1;
+
+    this->root = new_root;
+    this->levels++;
+  }
+
+  /**
+   * Removes the `position`-th key of `parent` and the child to its right.
+   */
+  static void erase_from(Inner &parent, uint32_t position)
+  {
+    std::move(parent.keys + position + 1, parent.keys + parent.count,
+              parent.keys + position);
+    std::move(parent.children + position + 2,
+              parent.children + parent.count + 1,
+              parent.children + position + 1);
+    parent.count--;
+    pad(parent.keys, parent.count, parent.count + 1);
+  }
+
+  /**
+   * Merges the leaves on both sides of the `position`-th key of `parent` if
+   * they fit in one, or otherwise evens their counts out.
+   *
+   * @returns Whether they were merged, which takes a key from `parent`.
+   */
+  bool rebalance_leaves(Inner &parent, uint32_t position)
+  {
+    const auto right_index = parent.children[position + 1];
+    Leaf &left = this->leaves[parent.children[position]];
+    Leaf &right = this->leaves[right_index];
+    const auto total = left.count + right.count;
+
+    if (total <= leaf_capacity)
+    {
+      std::move(right.keys, right.keys + right.count, left.keys + left.count);
+      std::move(right.values, right.values + right.count,
+                left.values + left.count);
+      left.count = total;
+      left.next = right.next;
+
+      this->leaves.free(right_index);
+      erase_from(parent, position);
+      return true;
+    }
+
+    const auto target = total / 2;
+    if (left.count < target)
+    {
+      const auto moved = target - left.count;
+      std::move(right.keys, right.keys + moved, left.keys + left.count);
+      std::move(right.values, right.values + moved, left.values + left.count);
+      std::move(right.keys + moved, right.keys + right.count, right.keys);
+      std::move(right.values + moved, right.values + right.count,
+                right.values);
+      pad(right.keys, right.count - moved, right.count);
+    }
+    else
+    {
+      const auto moved = left.count - target;
+      std::move_backward(right.keys, right.keys + right.count,
+                         right.keys + right.count + moved);
+      std::move_backward(right.values, right.values + right.count,
+                         right.values + right.count + moved);
+      std::move(left.keys + target, left.keys + left.count, right.keys);
+      std::move(left.values + target, left.values + left.count,
+                right.values);
+      pad(left.keys, target, left.count);
+    }
+
+    right.count = total - target;
+    left.count = target;
+    parent.keys[position] = right.keys[0];
+    return false;
+  }
+
+  /**
+   * Merges the inner nodes on both sides of the `position`-th key of
+   * `parent`, along with that key, if they fit in one, or otherwise evens
+   * their counts out by rotating keys through `parent`.
+   *
+   * @returns Whether they were merged, which takes a key from `parent`.
+   */
+  bool rebalance_inners(Inner &parent, uint32_t position)
+  {
+    const auto right_index = parent.children[position + 1];
+    Inner &left = this->inners[parent.children[position]];
+    Inner &right = this->inners[right_index];
+    const auto total = left.count + 1 + right.count;
+
+    if (total <= inner_capacity)
+    {
+      left.keys[left.count] = std::move(parent.keys[position]);
+      std::move(right.keys, right.keys + right.count,
+                left.keys + left.count + 1);
+      std::copy(right.children, right.children + right.count + 1,
+                left.children + left.count + 1);
+      left.count = total;
+
+      this->inners.free(right_index);
+      erase_from(parent, position);
+      return true;
+    }
+
+    const auto target = (total - 1) / 2;
+    if (left.count < target)
+    {
+      const auto moved = target - left.count;
+      left.keys[left.count] = std::move(parent.keys[position]);
+      std::move(right.keys, right.keys + moved - 1,
+                left.keys + left.count + 1);
+      std::copy(right.children, right.children + moved,
+                left.children + left.count + 1);
+      parent.keys[position] = std::move(right.keys[moved - 1]);
+
+      std::move(right.keys + moved, right.keys + right.count, right.keys);
+      std::copy(right.children + moved, right.children + right.count + 1,
+                right.children);
+      pad(right.keys, right.count - moved, right.count);
+      right.count -= moved;
+      left.count += moved;
+    }
+    else
+    {
+      const auto moved = left.count - target;
+      std::move_backward(right.keys, right.keys + right.count,
+                         right.keys + right.count + moved);
+      std::copy_backward(right.children, right.children + right.count + 1,
+                         right.children + right.count + 1 + moved);
+      right.keys[moved - 1] = std::move(parent.keys[position]);
+      std::move(left.keys + target + 1, left.keys + left.count, right.keys);
+      std::copy(left.children + target + 1, left.children + left.count + 1,
+                right.children);
+      parent.keys[position] = std::move(left.keys[target]);
+
+      pad(left.keys, target, left.count);
+      left.count -= moved;
+      right.count += moved;
+    }
+
+    return false;
+  }
+
+  /**
+   * Restores the minimum counts after a removal from `leaf`, merging nodes
+   * up `path` as long as merges leave parents under their minimum.
+   */
+  void rebalance_after_removal(const Leaf &leaf)
+  {
+    if (leaf.count >= min_leaf_count) return;
+    {
+      const auto [index, child] = this->path.back();
+      if (!this->rebalance_leaves(this->inners[index],
+                                  child > 0 ? child - 1 : 0))
+      {
+        return;
+      }
+    }
+
+    for (auto level = this->path.size(); level-- > 0;)
+    {
+      const auto index = this->path[level].node;
+      const Inner &inner = this->inners[index];
+
+      if (level == 0)
+      {
+        if (inner.count == 0)
+        {
+          this->root = inner.children[0];
+          this->inners.free(index);
+          this->levels--;
+        }
+        return;
+      }
+      if (inner.count >= min_inner_count) return;
+
+      const auto [parent, child] = this->path[level - 1];
+      if (!this->rebalance_inners(this->inners[parent],
+                                  child > 0 ? child - 1 : 0))
+      {
+        return;
+      }
+    }
+  }
+
+public:
+  /**
+   * Walks over the entries in key order, from leaf to leaf. Entries are
+   * pairs of references to their key and value. Any insertion or removal
+   * invalidates it.
+   */
+  class Iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::pair<const K &, const V &>;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type;
+
+    Iterator() : tree(nullptr), leaf(none), position(0) {}
+
+    Iterator(const BPlusTree *tree, uint32_t leaf, uint32_t position)
+        : tree(tree), leaf(leaf), position(position)
+    {
+    }
+
+    const K &key() const
+    {
+      return this->tree->leaves[this->leaf].keys[this->position];
+    }
+
+    const V &value() const
+    {
+      return this->tree->leaves[this->leaf].values[this->position];
+    }
+
+    reference operator*() const
+    {
+      return reference(this->key(), this->value());
+    }
+
+    Iterator &operator++()
+    {
+      const Leaf &leaf = this->tree->leaves[this->leaf];
+      if (++this->position < leaf.count) return *this;
+
+      this->leaf = leaf.next;
+      this->position = 0;
+      if (this->leaf != none)
+      {
+        // the scan most likely goes on to the leaf after, too.
+        const auto next = this->tree->leaves[this->leaf].next;
+        if (next != none) core::utils::prefetch(&this->tree->leaves[next]);
+      }
+      return *this;
+    }
+
+    Iterator operator++(int)
+    {
+      auto previous = *this;
+      ++*this;
+      return previous;
+    }
+
+    bool operator==(const Iterator &other) const
+    {
+      return this->leaf == other.leaf && this->position == other.position;
+    }
+
+  private:
+    const BPlusTree *tree;
+    uint32_t leaf;
+    uint32_t position;
+  };
+
+  using iterator = Iterator;
+  using const_iterator = Iterator;
+
+  BPlusTree() : root(none), levels(0), first_leaf(none), _size(0) {}
+
+  /**
+   * Bulk loads the tree from `keys`, sorted in strictly increasing order,
+   * and the values at the same positions of `values`. It builds the tree
+   * level by level in linear time, with every node at least half full.
+   */
+  BPlusTree(std::span<const K> keys, std::span<const V> values) noexcept(false)
+      : BPlusTree()
+  {
+    if (values.size() < keys.size())
+    {
+      throw std::invalid_argument("There must be a value for each key");
+    }
+    for (size_t i = 1; i < keys.size(); i++)
+    {
+      if (!(keys[i - 1] < keys[i]))
+      {
+        throw std::invalid_argument("Keys must be sorted and distinct");
+      }
+    }
+    if (keys.empty()) return;
+
+    // the nodes of the level being built, and the least key under each.
+    std::vector<uint32_t> nodes;
+    std::vector<K> least_keys;
+
+    const auto leaf_count =
+        (keys.size() + leaf_capacity - 1) / leaf_capacity;
+    size_t offset = 0;
+    for (size_t i = 0; i < leaf_count; i++)
+    {
+      const auto count = (uint32_t)(keys.size() * (i + 1) / leaf_count -
+                                    keys.size() * i / leaf_count);
+      const auto index = this->leaves.allocate();
+      Leaf &leaf = this->leaves[index];
+
+      std::copy_n(keys.begin() + offset, count, leaf.keys);
+      std::copy_n(values.begin() + offset, count, leaf.values);
+      leaf.count = count;
+      if (!nodes.empty()) this->leaves[nodes.back()].next = index;
+
+      nodes.push_back(index);
+      least_keys.push_back(keys[offset]);
+      offset += count;
+    }
+
+    this->first_leaf = nodes.front();
+    this->levels = 1;
+    this->_size = keys.size();
+
+    while (nodes.size() > 1)
+    {
+      std::vector<uint32_t> parents;
+      std::vector<K> parents_least_keys;
+      const auto parent_count =
+          (nodes.size() + inner_capacity) / (inner_capacity + 1);
+
+      size_t child = 0;
+      for (size_t i = 0; i < parent_count; i++)
+      {
+        const auto children =
+            (uint32_t)(nodes.size() * (i + 1) / parent_count -
+                       nodes.size() * i / parent_count);
+        const auto index = this->inners.allocate();
+        Inner &inner = this->inners[index];
+
+        std::copy_n(nodes.begin() + child, children, inner.children);
+        std::copy_n(least_keys.begin() + child + 1, children - 1,
+                    inner.keys);
+        inner.count = children - 1;
+
+        parents.push_back(index);
+        parents_least_keys.push_back(least_keys[child]);
+        child += children;
+      }
+
+      nodes = std::move(parents);
+      least_keys = std::move(parents_least_keys);
+      this->levels++;
+    }
+
+    this->root = nodes.front();
+  }
+
+  BPlusTree(BPlusTree &&other) noexcept
+      : leaves(std::move(other.leaves)), inners(std::move(other.inners)),
+        root(std::exchange(other.root, none)),
+        levels(std::exchange(other.levels, 0)),
+        first_leaf(std::exchange(other.first_leaf, none)),
+        _size(std::exchange(other._size, 0))
+  {
+  }
+
+  BPlusTree &operator=(BPlusTree &&other) noexcept
+  {
+    this->leaves = std::move(other.leaves);
+    this->inners = std::move(other.inners);
+    this->root = std::exchange(other.root, none);
+    this->levels = std::exchange(other.levels, 0);
+    this->first_leaf = std::exchange(other.first_leaf, none);
+    this->_size = std::exchange(other._size, 0);
+    return *this;
+  }
+
+  Iterator begin() const { return Iterator(this, this->first_leaf, 0); }
+  Iterator end() const { return Iterator(this, none, 0); }
+
+  /**
+   * Finds the first entry whose key is not less than `key`.
+   */
+  Iterator lower_bound(const K &key) const
+  {
+    if (this->levels == 0) return this->end();
+
+    const auto index = this->find_leaf(key);
+    const Leaf &leaf = this->leaves[index];
+    const auto position = position_in(leaf, key);
+    if (position < leaf.count) return Iterator(this, index, position);
+    return Iterator(this, leaf.next, 0);
+  }
+
+  /**
+   * Inserts `key` with `value`, or replaces the key's current value if it is
+   * already present. Throws a `std::invalid_argument` if `key` is NaN.
+   */
+  void insert(K key, V value) noexcept(false)
+  {
+    if constexpr (std::is_floating_point_v<K>)
+    {
+      // NaN is not ordered, so it has no place in the tree.
+      if (key != key) throw std::invalid_argument("Keys must not be NaN");
+    }
+
+    if (this->levels == 0)
+    {
+      this->root = this->first_leaf = this->leaves.allocate();
+      this->levels = 1;
+    }
+
+    const auto index = this->find_leaf_recording(key);
+    Leaf &leaf = this->leaves[index];
+    const auto position = position_in(leaf, key);
+
+    if (position < leaf.count && !(key < leaf.keys[position]))
+    {
+      leaf.values[position] = std::move(value);
+      return;
+    }
+    this->_size++;
+
+    if (leaf.count < leaf_capacity)
+    {
+      std::move_backward(leaf.keys + position, leaf.keys + leaf.count,
+                         leaf.keys + leaf.count + 1);
+      std::move_backward(leaf.values + position, leaf.values + leaf.count,
+                         leaf.values + leaf.count + 1);
+      leaf.keys[position] = std::move(key);
+      leaf.values[position] = std::move(value);
+      leaf.count++;
+      return;
+    }
+
+    // appending to the last leaf leaves it full, so that increasing keys
+    // fill every leaf rather than half of each.
+    const auto is_append = position == leaf.count && leaf.next == none;
+    const auto split = is_append ? leaf_capacity : leaf_capacity / 2;
+    const auto sibling_index = this->leaves.allocate();
+    Leaf &sibling = this->leaves[sibling_index];
+
+    std::move(leaf.keys + split, leaf.keys + leaf.count, sibling.keys);
+    std::move(leaf.values + split, leaf.values + leaf.count, sibling.values);
+    sibling.count = leaf.count - split;
+    pad(leaf.keys, split, leaf.count);
+    leaf.count = split;
+    sibling.next = leaf.next;
+    leaf.next = sibling_index;
+
+    Leaf &target = position < split ? leaf : sibling;
+    const auto target_position = position < split ? position : position - split;
+    std::move_backward(target.keys + target_position,
+                       target.keys + target.count,
+                       target.keys + target.count + 1);
+    std::move_backward(target.values + target_position,
+                       target.values + target.count,
+                       target.values + target.count + 1);
+    target.keys[target_position] = std::move(key);
+    target.values[target_position] = std::move(value);
+    target.count++;
+
+    this->insert_into_parents(sibling.keys[0], sibling_index);
+  }
+
+  void remove(const K &key)
+  {
+    if (this->levels == 0) return;
+
+    const auto index = this->find_leaf_recording(key);
+    Leaf &leaf = this->leaves[index];
+    const auto position = position_in(leaf, key);
+    if (position == leaf.count || key < leaf.keys[position]) return;
+
+    std::move(leaf.keys + position + 1, leaf.keys + leaf.count,
+              leaf.keys + position);
+    std::move(leaf.values + position + 1, leaf.values + leaf.count,
+              leaf.values + position);
+    leaf.count--;
+    pad(leaf.keys, leaf.count, leaf.count + 1);
+    this->_size--;
+
+    if (this->levels > 1)
+    {
+      this->rebalance_after_removal(leaf);
+    }
+    else if (leaf.count == 0)
+    {
+      this->clear();
+    }
+  }
+
+  /**
+   * Removes every entry at once, without walking the tree.
+   */
+  void clear()
+  {
+    this->leaves.clear();
+    this->inners.clear();
+    this->root = none;
+    this->levels = 0;
+    this->first_leaf = none;
+    this->_size = 0;
+  }
+
+  /**
+   * Looks `key` up without copying its value.
+   *
+   * @returns A pointer to the key's value, that is valid until the next
+   * insertion or removal, or `nullptr` if the key is not in the tree.
+   */
+  V *find(const K &key)
+  {
+    return const_cast<V *>(std::as_const(*this).find(key));
+  }
+
+  const V *find(const K &key) const
+  {
+    if (this->levels == 0) return nullptr;
+
+    const Leaf &leaf = this->leaves[this->find_leaf(key)];
+    const auto position = position_in(leaf, key);
+    if (position == leaf.count || key < leaf.keys[position]) return nullptr;
+    return &leaf.values[position];
+  }
+
+  const V *get(const K &key) const { return this->find(key); }
+
+  /**
+   * Counts entries from this tree instance.
+   */
+  size_t count() const { return this->_size; }
+
+  /**
+   * How many levels the tree has, leaves included.
+   */
+  size_t height() const { return this->levels; }
+
+  /**
+   * How many bytes the tree's nodes take, including unused slots.
+   */
+  size_t memory_usage() const
+  {
+    return this->leaves.bytes() + this->inners.bytes();
+  }
+};
+
+} // namespace core::trees
@@ -1,75 +1,441 @@
 #pragma once
 
+#include "trees/node_pool.hpp"
 #include <algorithm>
-#include <memory>
-#include <optional>
+#include <cstdint>
+#include <utility>
+#include <vector>
 
 namespace core::trees
 {
 
+/**
+ * An ordered map kept balanced as an AVL tree: the heights of every node's
+ * subtrees differ by one at most, so the tree is never over 1.44 log2(n)
+ * levels high, even if keys are inserted in order.
+ *
+ * Insertions and removals walk down iteratively, remembering the links they
+ * went through, then walk back up rebalancing the nodes along that path.
+ *
+ * Nodes live in a `NodePool` and link to their children by 32-bit indices.
+ * Each also knows its subtree's size, which rotations keep up to date just
+ * like heights, so that keys are ranked and selected by position in
+ * O(log n) as well.
+ */
 template <typename K, typename V> class BinarySearchTree
 {
 private:
   class Node
   {
-  private:
-    std::optional<std::unique_ptr<Node>> left_node;
-    std::optional<std::unique_ptr<Node>> right_node;
+  public:
     K key;
     V value;
+    uint32_t left_node;
+    uint32_t right_node;
+    /// How many nodes the subtree rooted at this node has, itself included.
+    uint32_t size;
+    /// The height of the subtree rooted at this node, leaves being 1 high.
+    uint8_t height;
+
+    Node(K key, V value)
+        : key(std::move(key)), value(std::move(value)),
+          left_node(NodePool<Node>::none), right_node(NodePool<Node>::none),
+          size(1), height(1)
+    {
+    }
   };
 
-  std::optional<std::unique_ptr<Node>> root;
-  V *search(K &key, Node &node) const;
+  static constexpr uint32_t none = NodePool<Node>::none;
+
+  NodePool<Node> nodes;
+  /// The index of the root node. Parents — or the tree, for the root — own
+  /// their children's indices, and rebalancing rewrites these links.
+  uint32_t root;
+
+  int height_of(uint32_t link) const
+  {
+    return link != none ? this->nodes[link].height : 0;
+  }
+
+  uint32_t size_of(uint32_t link) const
+  {
+    return link != none ? this->nodes[link].size : 0;
+  }
+
+  /**
+   * Recomputes the height and size of `node` from its children's.
+   */
+  void update(Node &node)
+  {
+    node.height = (uint8_t)(1 + std::max(this->height_of(node.left_node),
+                                         this->height_of(node.right_node)));
+    node.size =
+        1 + this->size_of(node.left_node) + this->size_of(node.right_node);
+  }
+
+  /**
+   * Makes the left child of the node at `link` its parent.
+   */
+  void rotate_right(uint32_t &link)
+  {
+    const auto index = link;
+    Node &node = this->nodes[index];
+    const auto pivot_index = node.left_node;
+    Node &pivot = this->nodes[pivot_index];
+
+    node.left_node = pivot.right_node;
+    this->update(node);
+    pivot.right_node = index;
+    this->update(pivot);
 
-  size_t count(Node &node)
+    link = pivot_index;
+  }
+
+  /**
+   * Makes the right child of the node at `link` its parent.
+   */
+  void rotate_left(uint32_t &link)
   {
-    size_t counter = 1;
-    if (node.left_node.has_value()) counter += count(*node.left_node.value());
-    if (node.right_node.has_value()) counter += count(*node.right_node.value());
-    return counter;
+    const auto index = link;
+    Node &node = this->nodes[index];
+    const auto pivot_index = node.right_node;
+    Node &pivot = this->nodes[pivot_index];
+
+    node.right_node = pivot.left_node;
+    this->update(node);
+    pivot.left_node = index;
+    this->update(pivot);
+
+    link = pivot_index;
   }
 
-  size_t height(Node &node)
+  /**
+   * Restores the balance of the node at `link`, whose subtrees' heights may
+   * differ by two after an insertion or a removal below it.
+   */
+  void rebalance(uint32_t &link)
   {
-    size_t counter = 1;
-    size_t left_height = 0;
-    size_t right_height = 0;
+    Node &node = this->nodes[link];
+    this->update(node);
+    const auto balance =
+        this->height_of(node.left_node) - this->height_of(node.right_node);
 
-    if (node.left_node.has_value())
+    if (balance > 1)
     {
-      left_height = height(*node.left_node.value());
+      const Node &left = this->nodes[node.left_node];
+      if (this->height_of(left.left_node) < this->height_of(left.right_node))
+      {
+        this->rotate_left(node.left_node);
+      }
+      this->rotate_right(link);
     }
+    else if (balance < -1)
+    {
+      const Node &right = this->nodes[node.right_node];
+      if (this->height_of(right.right_node) < this->height_of(right.left_node))
+      {
+        this->rotate_right(node.right_node);
+      }
+      this->rotate_left(link);
+    }
+  }
 
-    if (node.right_node.has_value())
+  /**
+   * Rebalances the nodes at `path`, from the deepest one up to the root.
+   * Links point into the nodes themselves, which never move.
+   */
+  void rebalance_path(const std::vector<uint32_t *> &path)
+  {
+    for (auto link = path.rbegin(); link != path.rend(); link++)
+    {
+      this->rebalance(**link);
+    }
+  }
+
+  uint32_t search(const K &key) const
+  {
+    auto index = this->root;
+
+    while (index != none)
     {
-      right_height = height(*node.right_node.value());
+      const Node &node = this->nodes[index];
+      if (key < node.key)
+      {
+        index = node.left_node;
+      }
+      else if (node.key < key)
+      {
+        index = node.right_node;
+      }
+      else
+      {
+        return index;
+      }
     }
 
-    counter += std::max(left_height, right_height);
-    return counter;
+    return none;
   }
 
 public:
-  void insert(K key, V value);
-  void remove(K key);
-  const V *get(K key) const;
+  BinarySearchTree() : root(none) {}
+
+  BinarySearchTree(BinarySearchTree &&other) noexcept
+      : nodes(std::move(other.nodes)), root(std::exchange(other.root, none))
+  {
+  }
+
+  BinarySearchTree &operator=(BinarySearchTree &&other) noexcept
+  {
+    this->nodes = std::move(other.nodes);
+    this->root = std::exchange(other.root, none);
+    return *this;
+  }
+
   /**
-   * Counts nodes from this tree instance.
+   * Inserts `key` with `value`, or replaces the key's current value if it is
+   * already present.
+   */
+  void insert(K key, V value)
+  {
+    std::vector<uint32_t *> path;
+    uint32_t *link = &this->root;
+
+    while (*link != none)
+    {
+      Node &node = this->nodes[*link];
+      if (key < node.key)
+      {
+        path.push_back(link);
+        link = &node.left_node;
+      }
+      else if (node.key < key)
+      {
+        path.push_back(link);
+        link = &node.right_node;
+      }
+      else
+      {
+        node.value = std::move(value);
+        return;
+      }
+    }
+
+    *link = this->nodes.allocate(std::move(key), std::move(value));
+    this->rebalance_path(path);
+  }
+
+  void remove(const K &key)
+  {
+    std::vector<uint32_t *> path;
+    uint32_t *link = &this->root;
+
+    while (*link != none)
+    {
+      Node &node = this->nodes[*link];
+      if (!(key < node.key) && !(node.key < key)) break;
+
+      path.push_back(link);
+      link = key < node.key ? &node.left_node : &node.right_node;
+    }
+    if (*link == none) return;
+
+    const auto index = *link;
+    Node &node = this->nodes[index];
+    if (node.left_node != none && node.right_node != none)
+    {
+      // takes the place of its successor, the leftmost node of its right
+      // subtree, which is then unlinked instead.
+      path.push_back(link);
+      uint32_t *successor = &node.right_node;
+      while (this->nodes[*successor].left_node != none)
+      {
+        path.push_back(successor);
+        successor = &this->nodes[*successor].left_node;
+      }
+
+      Node &successor_node = this->nodes[*successor];
+      std::swap(node.key, successor_node.key);
+      std::swap(node.value, successor_node.value);
+      link = successor;
+    }
+
+    // the node has at most one child, which takes its place.
+    const auto removed = *link;
+    const Node &removed_node = this->nodes[removed];
+    *link = removed_node.left_node != none ? removed_node.left_node
+                                           : removed_node.right_node;
+    this->nodes.free(removed);
+    this->rebalance_path(path);
+  }
+
+  /**
+   * Removes every node at once, without walking the tree.
+   */
+  void clear()
+  {
+    this->nodes.clear();
+    this->root = none;
+  }
+
+  /**
+   * Looks `key` up without copying its value.
+   *
+   * @returns A pointer to the key's value, or `nullptr` if the key is not in
+   * the tree.
    */
-  size_t count() const
+  V *find(const K &key)
+  {
+    const auto index = this->search(key);
+    return index != none ? &this->nodes[index].value : nullptr;
+  }
+
+  const V *find(const K &key) const
   {
-    if (!this->root.has_value()) return 0;
-    return count(*this->root.value());
+    const auto index = this->search(key);
+    return index != none ? &this->nodes[index].value : nullptr;
   }
+
+  const V *get(const K &key) const { return this->find(key); }
+
+  /**
+   * Counts nodes from this tree instance.
+   */
+  size_t count() const { return this->nodes.size(); }
+
   /**
    * Gets the height of the tree (i.e., the deepness of its deepest node).
    */
-  size_t height() const
+  size_t height() const { return this->height_of(this->root); }
+
+  /**
+   * Counts the keys less than `key`, which is the position `key` has — or
+   * would have — in key order.
+   */
+  size_t rank(const K &key) const
   {
-    if (!this->root.has_value()) return 0;
-    return height(*this->root.value());
+    size_t rank = 0;
+    auto index = this->root;
+
+    while (index != none)
+    {
+      const Node &node = this->nodes[index];
+      if (node.key < key)
+      {
+        rank += 1 + this->size_of(node.left_node);
+        index = node.right_node;
+      }
+      else
+      {
+        index = node.left_node;
+      }
+    }
+
+    return rank;
   }
+
+  /**
+   * Finds the `position`-th smallest key, counting from zero.
+   *
+   * @returns A pointer to the key, or `nullptr` if there are not as many.
+   */
+  const K *select(size_t position) const
+  {
+    if (position >= this->count()) return nullptr;
+    auto index = this->root;
+
+    while (true)
+    {
+      const Node &node = this->nodes[index];
+      const auto left_size = this->size_of(node.left_node);
+
+      if (position < left_size)
+      {
+        index = node.left_node;
+      }
+      else if (position == left_size)
+      {
+        return &node.key;
+      }
+      else
+      {
+        position -= left_size + 1;
+        index = node.right_node;
+      }
+    }
+  }
+
+  /**
+   * Counts the keys from `low` up to, but not including, `high`.
+   */
+  size_t count_in_range(const K &low, const K &high) const
+  {
+    if (!(low < high)) return 0;
+    return this->rank(high) - this->rank(low);
+  }
+
+  /**
+   * Calls `f` with every key from `low` up to, but not including, `high`,
+   * and its value, in key order.
+   */
+  template <typename F>
+  void for_each_in_range(const K &low, const K &high, F &&f) const
+  {
+    std::vector<uint32_t> stack;
+    auto index = this->root;
+
+    while (index != none || !stack.empty())
+    {
+      // goes down to the least key not less than `low`, skipping the left
+      // subtrees that are entirely less.
+      while (index != none)
+      {
+        const Node &node = this->nodes[index];
+        if (node.key < low)
+        {
+          index = node.right_node;
+          continue;
+        }
+        stack.push_back(index);
+        index = node.left_node;
+      }
+      if (stack.empty()) return;
+
+      const Node &node = this->nodes[stack.back()];
+      stack.pop_back();
+      if (!(node.key < high)) return;
+
+      f(node.key, node.value);
+      index = node.right_node;
+    }
+  }
+
+  /**
+   * Calls `f` with every key and its value, in key order.
+   */
+  template <typename F> void for_each(F &&f) const
+  {
+    std::vector<uint32_t> stack;
+    auto index = this->root;
+
+    while (index != none || !stack.empty())
+    {
+      while (index != none)
+      {
+        stack.push_back(index);
+        index = this->nodes[index].left_node;
+      }
+
+      const Node &node = this->nodes[stack.back()];
+      stack.pop_back();
+      f(node.key, node.value);
+      index = node.right_node;
+    }
+  }
+
+  /**
+   * How many bytes the tree's nodes take, including unused slots.
+   */
+  size_t memory_usage() const { return this->nodes.bytes(); }
 };
 
 } // namespace core::trees
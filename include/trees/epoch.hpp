@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace core::trees::internal
+{
+
+/**
+ * Frees memory unlinked from a lock-free structure once no thread may still
+ * be reading it, by epoch-based reclamation (Fraser, "Practical
+ * lock-freedom").
+ *
+ * Threads access the structure within a `Guard`, which announces the global
+ * epoch it started in. Memory is retired along with the epoch it was
+ * unlinked in, and the epoch only advances once every guard has announced
+ * the current one. Thus, by the time it's two epochs ahead, any guard that
+ * could have reached the memory before it was unlinked has been dropped.
+ */
+class EpochReclaimer
+{
+private:
+  /// Announced by idle slots, as epochs start at 1.
+  static constexpr uint64_t idle = 0;
+  /// A slot tries to free its retired pointers every time it holds another
+  /// multiple of these many.
+  static constexpr size_t retired_threshold = 64;
+
+  struct Retired
+  {
+    void *pointer;
+    void (*destroy)(void *);
+    uint64_t epoch;
+  };
+
+  struct alignas(64) Slot
+  {
+    std::atomic<bool> claimed = false;
+    std::atomic<uint64_t> epoch = idle;
+    /// Only touched by the guard that claimed the slot.
+    std::vector<Retired> retired;
+  };
+
+  std::atomic<uint64_t> epoch = 1;
+  std::unique_ptr<Slot[]> slots;
+  size_t slots_count;
+
+  /**
+   * Advances the epoch unless a guard has yet to announce the current one.
+   */
+  void try_advance()
+  {
+    auto epoch = this->epoch.load();
+
+    for (size_t i = 0; i < this->slots_count; i++)
+    {
+      const auto announced = this->slots[i].epoch.load();
+      if (announced != idle && announced != epoch) return;
+    }
+
+    this->epoch.compare_exchange_strong(epoch, epoch + 1);
+  }
+
+  /**
+   * Frees the memory `slot` retired at least two epochs ago.
+   */
+  void reclaim(Slot &slot)
+  {
+    const auto epoch = this->epoch.load();
+    std::erase_if(slot.retired,
+                  [&](const Retired &retired)
+                  {
+                    if (retired.epoch + 2 > epoch) return false;
+                    retired.destroy(retired.pointer);
+                    return true;
+                  });
+  }
+
+public:
+  /**
+   * Keeps the memory reachable when it is created from being freed until
+   * it's dropped. Guards are meant to be short lived: they hold back every
+   * retired memory, from any thread.
+   */
+  class Guard
+  {
+  private:
+    EpochReclaimer &reclaimer;
+    Slot *slot;
+
+  public:
+    Guard(EpochReclaimer &reclaimer) : reclaimer(reclaimer)
+    {
+      // each thread goes back to the slot it last claimed, which no other
+      // thread is likely to be after.
+      thread_local size_t hint =
+          std::hash<std::thread::id>{}(std::this_thread::get_id());
+
+      auto index = hint % reclaimer.slots_count;
+      while (reclaimer.slots[index].claimed.exchange(
+          true, std::memory_order_acquire))
+      {
+        index = (index + 1) % reclaimer.slots_count;
+        if (index == hint % reclaimer.slots_count) std::this_thread::yield();
+      }
+
+      hint = index;
+      this->slot = &reclaimer.slots[index];
+      this->slot->epoch.store(reclaimer.epoch.load());
+      // the announcement must be visible before anything is read.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    Guard(const Guard &) = delete;
+    Guard &operator=(const Guard &) = delete;
+
+    ~Guard()
+    {
+      this->slot->epoch.store(idle, std::memory_order_release);
+      this->slot->claimed.store(false, std::memory_order_release);
+    }
+
+    /**
+     * Frees `pointer` with `destroy` once no guard can reach it anymore. It
+     * must have been unlinked already.
+     */
+    void retire(void *pointer, void (*destroy)(void *))
+    {
+      Slot &slot = *this->slot;
+      slot.retired.push_back(
+          Retired{pointer, destroy, this->reclaimer.epoch.load()});
+
+      if (slot.retired.size() % retired_threshold != 0) return;
+      this->reclaimer.try_advance();
+      this->reclaimer.reclaim(slot);
+    }
+  };
+
+  EpochReclaimer()
+      : slots_count(std::max(1u, std::thread::hardware_concurrency()) * 4)
+  {
+    this->slots = std::make_unique<Slot[]>(this->slots_count);
+  }
+
+  EpochReclaimer(const EpochReclaimer &) = delete;
+  EpochReclaimer &operator=(const EpochReclaimer &) = delete;
+
+  /**
+   * Frees everything still retired. No guard may be alive.
+   */
+  ~EpochReclaimer()
+  {
+    for (size_t i = 0; i < this->slots_count; i++)
+    {
+      for (const auto &retired : this->slots[i].retired)
+      {
+        retired.destroy(retired.pointer);
+      }
+    }
+  }
+};
+
+} // namespace core::trees::internal
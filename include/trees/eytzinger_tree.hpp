@@ -0,0 +1,146 @@
+#pragma once
+
+#include "utils.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace core::trees
+{
+
+namespace internal
+{
+
+/**
+ * Allocates memory aligned to `Alignment` bytes, such as a cache line.
+ */
+template <typename T, size_t Alignment> struct AlignedAllocator
+{
+  using value_type = T;
+
+  template <typename U> struct rebind
+  {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() = default;
+
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment> &)
+  {
+  }
+
+  T *allocate(size_t count)
+  {
+    return static_cast<T *>(
+        ::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+  }
+
+  void deallocate(T *pointer, size_t)
+  {
+    ::operator delete(pointer, std::align_val_t(Alignment));
+  }
+
+  template <typename U>
+  bool operator==(const AlignedAllocator<U, Alignment> &) const
+  {
+    return true;
+  }
+};
+
+} // namespace internal
+
+/**
+ * A static set of keys laid out in Eytzinger order: the implicit binary
+ * search tree over the sorted keys, stored level by level as a heap is, so
+ * that the children of the key at `k` are at `2k` and `2k + 1`.
+ *
+ * A binary search over a sorted array touches keys far apart until its last
+ * few steps. Here, the keys a search may go through next are right after
+ * each other, so the descent prefetches the cache line holding all of its
+ * descendants a few levels down while it's still comparing, and each step
+ * chooses its child arithmetically rather than by branching.
+ */
+template <typename K> class EytzingerTree
+{
+private:
+  /// How many keys fit in a cache line, and thus how many levels down the
+  /// descent prefetches: the descendants of `k` that are `log2(lookahead)`
+  /// levels below it start at `k * lookahead`, one after another.
+  static constexpr size_t lookahead = std::max<size_t>(64 / sizeof(K), 1);
+
+  /// The keys from position 1 on. Position 0 is left unused so that
+  /// children are found by doubling.
+  std::vector<K, internal::AlignedAllocator<K, 64>> keys;
+
+  /**
+   * Fills the subtree at `position` with the next keys from `sorted`, in
+   * order: its left subtree, itself, then its right subtree.
+   */
+  void build(std::span<const K> sorted, size_t &next, size_t position)
+  {
+    if (position >= this->keys.size()) return;
+
+    this->build(sorted, next, position * 2);
+    this->keys[position] = sorted[next++];
+    this->build(sorted, next, position * 2 + 1);
+  }
+
+public:
+  /**
+   * Builds the set from `sorted`, in non-decreasing order, in linear time.
+   */
+  EytzingerTree(std::span<const K> sorted) noexcept(false)
+      : keys(sorted.size() + 1)
+  {
+    if (!std::ranges::is_sorted(sorted))
+    {
+      throw std::invalid_argument("Keys must be sorted");
+    }
+
+    size_t next = 0;
+    this->build(sorted, next, 1);
+  }
+
+  size_t size() const { return this->keys.size() - 1; }
+
+  /**
+   * Finds the least key not less than `key`.
+   *
+   * @returns A pointer to the key, or `nullptr` if every key is less.
+   */
+  const K *lower_bound(const K &key) const
+  {
+    const K *keys = this->keys.data();
+    const auto size = this->keys.size();
+    size_t position = 1;
+
+    while (position < size)
+    {
+      core::utils::prefetch(keys + std::min(position * lookahead, size - 1));
+      position = position * 2 + (keys[position] < key);
+    }
+
+    // the descent went right — past lesser keys — since it last went left,
+    // at the key it's looking for. Those right turns are the trailing ones.
+    position >>= std::countr_one(position) + 1;
+    return position ? keys + position : nullptr;
+  }
+
+  bool contains(const K &key) const
+  {
+    const K *found = this->lower_bound(key);
+    return found && !(key < *found);
+  }
+
+  /**
+   * How many bytes the keys take.
+   */
+  size_t memory_usage() const { return this->keys.capacity() * sizeof(K); }
+};
+
+} // namespace core::trees
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace core::trees
+{
+
+/**
+ * Stores a tree's nodes in slabs of contiguous memory, and hands out 32-bit
+ * indices to them rather than pointers: links take half the memory, nodes
+ * allocated together sit next to each other, and since no node knows where
+ * another one lives, moving the pool — or the tree owning it — never
+ * invalidates its links.
+ *
+ * Slabs never move once allocated, so references to nodes stay valid until
+ * they're freed. Freed slots are reused, newest first.
+ */
+template <typename T> class NodePool
+{
+public:
+  /// The index of no node, such as a leaf's children.
+  static constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+
+private:
+  static constexpr bool tracks_values = !std::is_trivially_destructible_v<T>;
+
+  union Slot
+  {
+    T value;
+    uint32_t next_free;
+
+    Slot() : next_free(none) {}
+    ~Slot() {}
+  };
+
+  /// Slabs take about 64 KiB, however big nodes are.
+  static constexpr uint32_t slab_bits =
+      std::max<uint32_t>(std::bit_width((64u << 10) / sizeof(Slot)), 5) - 1;
+  static constexpr uint32_t slab_size = 1 << slab_bits;
+
+  std::vector<std::unique_ptr<Slot[]>> slabs;
+  /// How many slots were ever handed out. The ones past them are untouched.
+  uint32_t used;
+  uint32_t free_head;
+  size_t _size;
+  /// Which slots hold a value, so that they're destroyed along with the pool.
+  /// Only tracked if destroying values is not a no-op.
+  std::vector<bool> live;
+
+  Slot &slot(uint32_t index)
+  {
+    return this->slabs[index >> slab_bits][index & (slab_size - 1)];
+  }
+
+  const Slot &slot(uint32_t index) const
+  {
+    return this->slabs[index >> slab_bits][index & (slab_size - 1)];
+  }
+
+  void destroy_values()
+  {
+    if constexpr (tracks_values)
+    {
+      for (uint32_t index = 0; index < this->used; index++)
+      {
+        if (this->live[index]) std::destroy_at(&this->slot(index).value);
+      }
+    }
+  }
+
+public:
+  NodePool() : used(0), free_head(none), _size(0) {}
+
+  NodePool(NodePool &&other) noexcept
+      : slabs(std::move(other.slabs)), used(std::exchange(other.used, 0)),
+        free_head(std::exchange(other.free_head, none)),
+        _size(std::exchange(other._size, 0)), live(std::move(other.live))
+  {
+  }
+
+  NodePool &operator=(NodePool &&other) noexcept
+  {
+    if (this == &other) return *this;
+
+    this->destroy_values();
+    this->slabs = std::move(other.slabs);
+    this->used = std::exchange(other.used, 0);
+    this->free_head = std::exchange(other.free_head, none);
+    this->_size = std::exchange(other._size, 0);
+    this->live = std::move(other.live);
+    return *this;
+  }
+
+  ~NodePool() { this->destroy_values(); }
+
+  /**
+   * Constructs a node from `args` in a free slot.
+   *
+   * @returns The node's index.
+   */
+  template <typename... Args> uint32_t allocate(Args &&...args) noexcept(false)
+  {
+    const auto reuses_slot = this->free_head != none;
+    const auto index = reuses_slot ? this->free_head : this->used;
+
+    if (!reuses_slot)
+    {
+      if (index == none) throw std::length_error("The node pool is full");
+      if ((index >> slab_bits) == this->slabs.size())
+      {
+        this->slabs.push_back(std::make_unique<Slot[]>(slab_size));
+      }
+    }
+
+    Slot &slot = this->slot(index);
+    const auto next_free = slot.next_free;
+    std::construct_at(&slot.value, std::forward<Args>(args)...);
+
+    if (reuses_slot)
+    {
+      this->free_head = next_free;
+    }
+    else
+    {
+      this->used++;
+      if constexpr (tracks_values) this->live.push_back(false);
+    }
+
+    if constexpr (tracks_values) this->live[index] = true;
+    this->_size++;
+    return index;
+  }
+
+  /**
+   * Destroys the node at `index`, whose slot may then be reused.
+   */
+  void free(uint32_t index)
+  {
+    Slot &slot = this->slot(index);
+    std::destroy_at(&slot.value);
+    slot.next_free = this->free_head;
+    this->free_head = index;
+
+    if constexpr (tracks_values) this->live[index] = false;
+    this->_size--;
+  }
+
+  /**
+   * Destroys every node at once and releases the slabs. It takes a pass over
+   * the slabs rather than the nodes, unless nodes have destructors to run.
+   */
+  void clear()
+  {
+    this->destroy_values();
+    this->slabs.clear();
+    this->live = std::vector<bool>();
+    this->used = 0;
+    this->free_head = none;
+    this->_size = 0;
+  }
+
+  T &operator[](uint32_t index) { return this->slot(index).value; }
+  const T &operator[](uint32_t index) const
+  {
+    return this->slot(index).value;
+  }
+
+  /// How many nodes are allocated.
+  size_t size() const { return this->_size; }
+
+  /// How many bytes the slabs take, free slots included.
+  size_t bytes() const
+  {
+    return this->slabs.size() * slab_size * sizeof(Slot) +
+           this->live.capacity() / 8;
+  }
+};
+
+} // namespace core::trees
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <bit>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace core::trees::internal
+{
+
+/**
+ * Counts how many of the `count` keys at `keys` are less than `key`, or
+ * greater than it if `Greater` is set. `count` must be a multiple of 4.
+ *
+ * Nodes of wide trees are searched by counting rather than by bisecting: it
+ * takes no branches, and 32-bit and 64-bit integers are compared a whole
+ * vector at a time, with SSE2 (SSE4.2 or AVX2 for 64-bit ones) or NEON. Any
+ * other key is compared one at a time.
+ */
+template <bool Greater, typename K>
+size_t count_compared(const K *keys, size_t count, const K &key)
+{
+  [[maybe_unused]] constexpr bool is_simd_key =
+      std::is_integral_v<K> && (sizeof(K) == 4 || sizeof(K) == 8);
+
+#if defined(__SSE2__)
+  // SSE only compares signed integers, so unsigned ones are shifted into
+  // their range by flipping their sign bit, which keeps their order.
+  if constexpr (is_simd_key && sizeof(K) == 4)
+  {
+    const auto flip = _mm_set1_epi32(std::is_signed_v<K> ? 0 : INT32_MIN);
+    const auto pivot = _mm_xor_si128(_mm_set1_epi32((int32_t)key), flip);
+    size_t compared = 0;
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+      const auto block = _mm_xor_si128(
+          _mm_loadu_si128((const __m128i *)(keys + i)), flip);
+      const auto mask = Greater ? _mm_cmpgt_epi32(block, pivot)
+                                : _mm_cmpgt_epi32(pivot, block);
+      compared += std::popcount(
+          (unsigned)_mm_movemask_ps(_mm_castsi128_ps(mask)));
+    }
+    return compared;
+  }
+#endif
+
+#if defined(__AVX2__)
+  if constexpr (is_simd_key && sizeof(K) == 8)
+  {
+    const auto flip = _mm256_set1_epi64x(std::is_signed_v<K> ? 0 : INT64_MIN);
+    const auto pivot =
+        _mm256_xor_si256(_mm256_set1_epi64x((int64_t)key), flip);
+    size_t compared = 0;
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+      const auto block = _mm256_xor_si256(
+          _mm256_loadu_si256((const __m256i *)(keys + i)), flip);
+      const auto mask = Greater ? _mm256_cmpgt_epi64(block, pivot)
+                                : _mm256_cmpgt_epi64(pivot, block);
+      compared += std::popcount(
+          (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(mask)));
+    }
+    return compared;
+  }
+#elif defined(__SSE4_2__)
+  if constexpr (is_simd_key && sizeof(K) == 8)
+  {
+    const auto flip = _mm_set1_epi64x(std::is_signed_v<K> ? 0 : INT64_MIN);
+    const auto pivot = _mm_xor_si128(_mm_set1_epi64x((int64_t)key), flip);
+    size_t compared = 0;
+
+    for (size_t i = 0; i < count; i += 2)
+    {
+      const auto block = _mm_xor_si128(
+          _mm_loadu_si128((const __m128i *)(keys + i)), flip);
+      const auto mask = Greater ? _mm_cmpgt_epi64(block, pivot)
+                                : _mm_cmpgt_epi64(pivot, block);
+      compared += std::popcount(
+          (unsigned)_mm_movemask_pd(_mm_castsi128_pd(mask)));
+    }
+    return compared;
+  }
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+  // NEON compares unsigned integers, so it's signed ones whose sign bit is
+  // flipped. Matching lanes are all ones, that is -1, so subtracting them
+  // counts them.
+  if constexpr (is_simd_key && sizeof(K) == 4)
+  {
+    const auto flip = vdupq_n_u32(std::is_signed_v<K> ? 1u << 31 : 0);
+    const auto pivot = veorq_u32(vdupq_n_u32((uint32_t)key), flip);
+    auto compared = vdupq_n_u32(0);
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+      const auto block =
+          veorq_u32(vld1q_u32((const uint32_t *)(keys + i)), flip);
+      const auto mask =
+          Greater ? vcgtq_u32(block, pivot) : vcltq_u32(block, pivot);
+      compared = vsubq_u32(compared, mask);
+    }
+    return vaddvq_u32(compared);
+  }
+
+  if constexpr (is_simd_key && sizeof(K) == 8)
+  {
+    const auto flip = vdupq_n_u64(std::is_signed_v<K> ? 1ull << 63 : 0);
+    const auto pivot = veorq_u64(vdupq_n_u64((uint64_t)key), flip);
+    auto compared = vdupq_n_u64(0);
+
+    for (size_t i = 0; i < count; i += 2)
+    {
+      const auto block =
+          veorq_u64(vld1q_u64((const uint64_t *)(keys + i)), flip);
+      const auto mask =
+          Greater ? vcgtq_u64(block, pivot) : vcltq_u64(block, pivot);
+      compared = vsubq_u64(compared, mask);
+    }
+    return vaddvq_u64(compared);
+  }
+#endif
+
+  size_t compared = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    compared += Greater ? key < keys[i] : keys[i] < key;
+  }
+  return compared;
+}
+
+} // namespace core::trees::internal
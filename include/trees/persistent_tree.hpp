@@ -0,0 +1,338 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace core::trees
+{
+
+/**
+ * An immutable ordered map, balanced as an AVL tree. `insert` and `remove`
+ * leave the tree untouched and return a new version of it instead, which
+ * copies the O(log n) nodes on the way to the key and shares every other
+ * node with the previous version.
+ *
+ * Copying a tree is thus an O(1) snapshot, that stays the same however the
+ * tree it was taken from goes on. Nodes are reference counted, atomically,
+ * so each is freed along with the last version holding it, whichever thread
+ * drops it. See `VersionedTree` to share the latest version between threads.
+ */
+template <typename K, typename V> class PersistentTree
+{
+private:
+  struct Node;
+  using Link = std::shared_ptr<const Node>;
+
+  struct Node
+  {
+    K key;
+    V value;
+    Link left_node;
+    Link right_node;
+    uint8_t height;
+  };
+
+  Link root;
+  size_t _size = 0;
+
+  PersistentTree(Link root, size_t size) : root(std::move(root)), _size(size)
+  {
+  }
+
+  static int height_of(const Link &link) { return link ? link->height : 0; }
+
+  static Link make(K key, V value, Link left, Link right)
+  {
+    const auto height =
+        (uint8_t)(1 + std::max(height_of(left), height_of(right)));
+    return std::make_shared<const Node>(Node{std::move(key), std::move(value),
+                                             std::move(left),
+                                             std::move(right), height});
+  }
+
+  /**
+   * Makes a node out of `key`, `value` and subtrees whose heights may
+   * differ by two, rotating them into balance. Rotations build new nodes
+   * too, rather than relinking the subtrees' ones.
+   */
+  static Link balance(const K &key, const V &value, Link left, Link right)
+  {
+    if (height_of(left) > height_of(right) + 1)
+    {
+      if (height_of(left->left_node) >= height_of(left->right_node))
+      {
+        return make(left->key, left->value, left->left_node,
+                    make(key, value, left->right_node, std::move(right)));
+      }
+
+      const Node &pivot = *left->right_node;
+      return make(pivot.key, pivot.value,
+                  make(left->key, left->value, left->left_node,
+                       pivot.left_node),
+                  make(key, value, pivot.right_node, std::move(right)));
+    }
+
+    if (height_of(right) > height_of(left) + 1)
+    {
+      if (height_of(right->right_node) >= height_of(right->left_node))
+      {
+        return make(right->key, right->value,
+                    make(key, value, std::move(left), right->left_node),
+                    right->right_node);
+      }
+
+      const Node &pivot = *right->left_node;
+      return make(pivot.key, pivot.value,
+                  make(key, value, std::move(left), pivot.left_node),
+                  make(right->key, right->value, pivot.right_node,
+                       right->right_node));
+    }
+
+    return make(key, value, std::move(left), std::move(right));
+  }
+
+  static Link insert(const Link &link, K &key, V &value, bool &inserted)
+  {
+    if (!link)
+    {
+      inserted = true;
+      return make(std::move(key), std::move(value), nullptr, nullptr);
+    }
+
+    if (key < link->key)
+    {
+      return balance(link->key, link->value,
+                     insert(link->left_node, key, value, inserted),
+                     link->right_node);
+    }
+    if (link->key < key)
+    {
+      return balance(link->key, link->value, link->left_node,
+                     insert(link->right_node, key, value, inserted));
+    }
+
+    return make(link->key, std::move(value), link->left_node,
+                link->right_node);
+  }
+
+  /**
+   * Removes the least node under `link`, pointing `least` to it.
+   */
+  static Link remove_least(const Link &link, const Node *&least)
+  {
+    if (!link->left_node)
+    {
+      least = link.get();
+      return link->right_node;
+    }
+
+    return balance(link->key, link->value,
+                   remove_least(link->left_node, least), link->right_node);
+  }
+
+  static Link remove(const Link &link, const K &key, bool &removed)
+  {
+    if (!link) return link;
+
+    if (key < link->key)
+    {
+      auto left = remove(link->left_node, key, removed);
+      if (!removed) return link;
+      return balance(link->key, link->value, std::move(left),
+                     link->right_node);
+    }
+    if (link->key < key)
+    {
+      auto right = remove(link->right_node, key, removed);
+      if (!removed) return link;
+      return balance(link->key, link->value, link->left_node,
+                     std::move(right));
+    }
+
+    removed = true;
+    if (!link->left_node) return link->right_node;
+    if (!link->right_node) return link->left_node;
+
+    // its successor takes its place. `link` keeps it alive meanwhile.
+    const Node *successor = nullptr;
+    auto right = remove_least(link->right_node, successor);
+    return balance(successor->key, successor->value, link->left_node,
+                   std::move(right));
+  }
+
+public:
+  PersistentTree() = default;
+
+  /**
+   * @returns A version of the tree with `key` set to `value`.
+   */
+  [[nodiscard]] PersistentTree insert(K key, V value) const
+  {
+    bool inserted = false;
+    auto root = insert(this->root, key, value, inserted);
+    return PersistentTree(std::move(root), this->_size + inserted);
+  }
+
+  /**
+   * @returns A version of the tree without `key`, which shares every node
+   * with this one if the key is not in it.
+   */
+  [[nodiscard]] PersistentTree remove(const K &key) const
+  {
+    bool removed = false;
+    auto root = remove(this->root, key, removed);
+    return PersistentTree(std::move(root), this->_size - removed);
+  }
+
+  /**
+   * Looks `key` up without copying its value.
+   *
+   * @returns A pointer to the key's value, that is valid as long as this
+   * version is, or `nullptr` if the key is not in the tree.
+   */
+  const V *find(const K &key) const
+  {
+    const Node *node = this->root.get();
+
+    while (node)
+    {
+      if (key < node->key)
+      {
+        node = node->left_node.get();
+      }
+      else if (node->key < key)
+      {
+        node = node->right_node.get();
+      }
+      else
+      {
+        return &node->value;
+      }
+    }
+
+    return nullptr;
+  }
+
+  const V *get(const K &key) const { return this->find(key); }
+
+  /**
+   * Calls `f` with every key from `low` up to, but not including, `high`,
+   * and its value, in key order.
+   */
+  template <typename F>
+  void for_each_in_range(const K &low, const K &high, F &&f) const
+  {
+    std::vector<const Node *> stack;
+    const Node *node = this->root.get();
+
+    while (node || !stack.empty())
+    {
+      // goes down to the least key not less than `low`, skipping the left
+      // subtrees that are entirely less.
+      while (node)
+      {
+        if (node->key < low)
+        {
+          node = node->right_node.get();
+          continue;
+        }
+        stack.push_back(node);
+        node = node->left_node.get();
+      }
+      if (stack.empty()) return;
+
+      node = stack.back();
+      stack.pop_back();
+      if (!(node->key < high)) return;
+
+      f(node->key, node->value);
+      node = node->right_node.get();
+    }
+  }
+
+  /**
+   * Calls `f` with every key and its value, in key order.
+   */
+  template <typename F> void for_each(F &&f) const
+  {
+    std::vector<const Node *> stack;
+    const Node *node = this->root.get();
+
+    while (node || !stack.empty())
+    {
+      while (node)
+      {
+        stack.push_back(node);
+        node = node->left_node.get();
+      }
+
+      node = stack.back();
+      stack.pop_back();
+      f(node->key, node->value);
+      node = node->right_node.get();
+    }
+  }
+
+  /**
+   * Counts nodes from this version.
+   */
+  size_t count() const { return this->_size; }
+
+  /**
+   * Gets the height of the tree (i.e., the deepness of its deepest node).
+   */
+  size_t height() const { return height_of(this->root); }
+};
+
+/**
+ * The latest version of a `PersistentTree`, shared between threads.
+ *
+ * Readers take a snapshot, which only holds a lock for as long as it takes
+ * to copy the root, and then read it as long as they need without any.
+ * Writers take turns building the next version off the latest one, then
+ * publish it. The versions they replace are freed once their last reader
+ * is done with them.
+ */
+template <typename K, typename V> class VersionedTree
+{
+private:
+  PersistentTree<K, V> latest;
+  /// Guards `latest` itself, not the nodes it points to.
+  mutable std::mutex latest_mutex;
+  std::mutex writer_mutex;
+
+  void publish(PersistentTree<K, V> version)
+  {
+    {
+      const std::lock_guard lock(this->latest_mutex);
+      std::swap(this->latest, version);
+    }
+    // the replaced version, now in `version`, is released without the lock.
+  }
+
+public:
+  PersistentTree<K, V> snapshot() const
+  {
+    const std::lock_guard lock(this->latest_mutex);
+    return this->latest;
+  }
+
+  void insert(K key, V value)
+  {
+    const std::lock_guard lock(this->writer_mutex);
+    // only writers replace `latest`, so reading it needs no other lock.
+    this->publish(this->latest.insert(std::move(key), std::move(value)));
+  }
+
+  void remove(const K &key)
+  {
+    const std::lock_guard lock(this->writer_mutex);
+    this->publish(this->latest.remove(key));
+  }
+};
+
+} // namespace core::trees
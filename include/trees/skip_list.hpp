@@ -0,0 +1,361 @@
+#pragma once
+
+#include "trees/epoch.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <optional>
+#include <thread>
+#include <type_traits>
+
+namespace core::trees
+{
+
+/**
+ * An ordered map that may be shared between threads, as a lock-free skip
+ * list (Herlihy and Shavit, "The Art of Multiprocessor Programming", 14.4).
+ *
+ * Every operation makes progress with atomic instructions alone. A node is
+ * removed by marking its links, which stops any more nodes from being
+ * linked after it, and then unlinked by whichever thread goes past it next.
+ * Unlinked nodes are freed by epoch-based reclamation, once no thread may
+ * still be reading them.
+ *
+ * Since values are replaced in place while readers may be copying them, `V`
+ * must be trivially copyable.
+ */
+template <typename K, typename V> class ConcurrentSkipList
+{
+  static_assert(std::is_trivially_copyable_v<V>,
+                "Values replaced in place require trivially copyable "
+                "values.");
+
+private:
+  /// Each level links a quarter of the nodes of the one below, so that
+  /// nodes take 1.33 links on average. 16 levels suit up to 4^16 keys.
+  static constexpr int max_height = 16;
+
+  /// A pointer to the next node, whose lowest bit marks the node holding it
+  /// as removed from that level.
+  using Link = std::atomic<uintptr_t>;
+
+  struct alignas(Link) Node
+  {
+    const K key;
+    std::atomic<V> value;
+    const uint8_t height;
+    /// Its insertion, then its removal: whichever of them finishes last
+    /// retires it, once neither can link it back anymore.
+    std::atomic<uint8_t> pending;
+
+    /// Its `height` links, allocated right after it.
+    Link *next() { return reinterpret_cast<Link *>(this + 1); }
+  };
+
+  using Guard = internal::EpochReclaimer::Guard;
+
+  internal::EpochReclaimer reclaimer;
+  Link head[max_height];
+  std::atomic<size_t> _size = 0;
+
+  static Node *pointer_of(uintptr_t link)
+  {
+    return reinterpret_cast<Node *>(link & ~uintptr_t(1));
+  }
+
+  static bool is_marked(uintptr_t link) { return link & 1; }
+
+  static Node *make_node(K key, const V &value, int height)
+  {
+    void *memory = ::operator new(sizeof(Node) + height * sizeof(Link));
+    auto *node = new (memory) Node{std::move(key), value, (uint8_t)height, 2};
+    for (int level = 0; level < height; level++)
+    {
+      new (&node->next()[level]) Link(0);
+    }
+    return node;
+  }
+
+  static void destroy(void *pointer)
+  {
+    static_cast<Node *>(pointer)->~Node();
+    ::operator delete(pointer);
+  }
+
+  static int random_height()
+  {
+    thread_local uint64_t state =
+        std::hash<std::thread::id>{}(std::this_thread::get_id()) | 1;
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+
+    const auto height = std::countr_zero(state | (1ull << 62)) / 2 + 1;
+    return std::min(height, max_height);
+  }
+
+  /**
+   * Descends to `key`, unlinking the removed nodes along the way.
+   *
+   * @returns Whether the key was found, or `std::nullopt` if another thread
+   * changed a link under the descent, which must then start over.
+   */
+  std::optional<bool> search(const K &key, Link **preds, Node **succs)
+  {
+    Link *pred = this->head;
+    Node *current = nullptr;
+
+    for (int level = max_height - 1; level >= 0; level--)
+    {
+      current = pointer_of(pred[level].load());
+
+      while (current)
+      {
+        const auto next = current->next()[level].load();
+        if (is_marked(next))
+        {
+          auto expected = (uintptr_t)current;
+          if (!pred[level].compare_exchange_strong(expected, next - 1))
+          {
+            return std::nullopt;
+          }
+          current = pointer_of(next);
+          continue;
+        }
+
+        if (!(current->key < key)) break;
+        pred = current->next();
+        current = pointer_of(next);
+      }
+
+      preds[level] = pred;
+      succs[level] = current;
+    }
+
+    return current && !(key < current->key);
+  }
+
+  /**
+   * Finds the links before and after `key` on every level.
+   */
+  bool find(const K &key, Link **preds, Node **succs)
+  {
+    while (true)
+    {
+      const auto found = this->search(key, preds, succs);
+      if (found) return *found;
+    }
+  }
+
+  /**
+   * Finds the first node not removed whose key is not less than `key`,
+   * without writing anything.
+   */
+  Node *lower_bound(const K &key)
+  {
+    Link *pred = this->head;
+    Node *current = nullptr;
+
+    for (int level = max_height - 1; level >= 0; level--)
+    {
+      current = pointer_of(pred[level].load());
+
+      while (current)
+      {
+        const auto next = current->next()[level].load();
+        if (!is_marked(next))
+        {
+          if (!(current->key < key)) break;
+          pred = current->next();
+        }
+        current = pointer_of(next);
+      }
+    }
+
+    return current;
+  }
+
+  /**
+   * Links `node`, linked on the bottom level already, on its upper levels.
+   * It gives up as soon as the node is removed.
+   */
+  void link_upper_levels(Node *node, Link **preds, Node **succs)
+  {
+    for (int level = 1; level < node->height; level++)
+    {
+      while (true)
+      {
+        auto next = node->next()[level].load();
+        if (is_marked(next)) return;
+
+        // only removals change it meanwhile, by marking it.
+        const auto succ = (uintptr_t)succs[level];
+        if (next != succ &&
+            !node->next()[level].compare_exchange_strong(next, succ))
+        {
+          return;
+        }
+
+        auto expected = succ;
+        if (preds[level][level].compare_exchange_strong(expected,
+                                                        (uintptr_t)node))
+        {
+          break;
+        }
+
+        this->find(node->key, preds, succs);
+        if (succs[0] != node) return;
+      }
+    }
+  }
+
+  void release(Guard &guard, Node *node)
+  {
+    if (node->pending.fetch_sub(1) == 1) guard.retire(node, destroy);
+  }
+
+public:
+  ConcurrentSkipList() = default;
+  ConcurrentSkipList(const ConcurrentSkipList &) = delete;
+  ConcurrentSkipList &operator=(const ConcurrentSkipList &) = delete;
+
+  /**
+   * Frees every node. No other thread may be using the list anymore.
+   */
+  ~ConcurrentSkipList()
+  {
+    Node *node = pointer_of(this->head[0].load());
+    while (node)
+    {
+      Node *next = pointer_of(node->next()[0].load());
+      destroy(node);
+      node = next;
+    }
+  }
+
+  size_t size() const { return this->_size.load(std::memory_order_relaxed); }
+
+  void insert(K key, V value)
+  {
+    Guard guard(this->reclaimer);
+    Link *preds[max_height];
+    Node *succs[max_height];
+
+    if (this->find(key, preds, succs))
+    {
+      succs[0]->value.store(value);
+      return;
+    }
+
+    const auto height = random_height();
+    Node *node = make_node(std::move(key), value, height);
+
+    while (true)
+    {
+      for (int level = 0; level < height; level++)
+      {
+        node->next()[level].store((uintptr_t)succs[level],
+                                  std::memory_order_relaxed);
+      }
+
+      auto expected = (uintptr_t)succs[0];
+      if (preds[0][0].compare_exchange_strong(expected, (uintptr_t)node))
+      {
+        break;
+      }
+
+      // another thread may have inserted the key meanwhile.
+      if (this->find(node->key, preds, succs))
+      {
+        succs[0]->value.store(value);
+        destroy(node);
+        return;
+      }
+    }
+
+    this->_size.fetch_add(1, std::memory_order_relaxed);
+    this->link_upper_levels(node, preds, succs);
+
+    // a removal that marked it before it was linked on every level may have
+    // missed some of its links, so they're unlinked here instead.
+    if (is_marked(node->next()[0].load())) this->find(node->key, preds, succs);
+    this->release(guard, node);
+  }
+
+  std::optional<V> get(const K &key)
+  {
+    Guard guard(this->reclaimer);
+
+    const Node *node = this->lower_bound(key);
+    if (!node || key < node->key) return std::nullopt;
+    return node->value.load();
+  }
+
+  bool contains(const K &key) { return this->get(key).has_value(); }
+
+  void remove(const K &key)
+  {
+    Guard guard(this->reclaimer);
+    Link *preds[max_height];
+    Node *succs[max_height];
+
+    if (!this->find(key, preds, succs)) return;
+    Node *node = succs[0];
+
+    for (int level = node->height - 1; level > 0; level--)
+    {
+      node->next()[level].fetch_or(1);
+    }
+
+    // marking the bottom level is what removes it, so only one thread does.
+    if (is_marked(node->next()[0].fetch_or(1))) return;
+
+    this->_size.fetch_sub(1, std::memory_order_relaxed);
+    this->find(key, preds, succs);
+    this->release(guard, node);
+  }
+
+  /**
+   * Calls `f` with every key from `low` up to, but not including, `high`,
+   * and its value, in key order.
+   *
+   * The scan is not a snapshot: it visits every key present throughout it,
+   * and may or may not visit those inserted or removed meanwhile. Memory is
+   * held back from reclamation while it runs, so `f` should be quick.
+   */
+  template <typename F>
+  void for_each_in_range(const K &low, const K &high, F &&f)
+  {
+    Guard guard(this->reclaimer);
+
+    Node *node = this->lower_bound(low);
+    while (node && node->key < high)
+    {
+      const auto next = node->next()[0].load();
+      if (!is_marked(next)) f(node->key, node->value.load());
+      node = pointer_of(next);
+    }
+  }
+
+  /**
+   * Calls `f` with every key and its value, in key order, as
+   * `for_each_in_range` does.
+   */
+  template <typename F> void for_each(F &&f)
+  {
+    Guard guard(this->reclaimer);
+
+    Node *node = pointer_of(this->head[0].load());
+    while (node)
+    {
+      const auto next = node->next()[0].load();
+      if (!is_marked(next)) f(node->key, node->value.load());
+      node = pointer_of(next);
+    }
+  }
+};
+
+} // namespace core::trees
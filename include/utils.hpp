@@ -1,5 +1,11 @@
 #pragma once
 
+#include "utils/buffered_writer.hpp"
+#include "utils/column_file.hpp"
+#include "utils/generators.hpp"
+#include "utils/mapped_file.hpp"
+#include "utils/resident_memory.hpp"
+#include <algorithm>
 #include <iostream>
 #include <span>
 #include <vector>
@@ -19,29 +25,44 @@ void swap(std::span<T> list, const size_t lhp, const size_t rhp)
 }
 
 /**
- * Stringifies and print each element from `vector` in JSON format.
+ * Hints the CPU to start loading the cache line at `address`, so that it's
+ * hopefully there by the time it's read. It's a no-op on unknown compilers.
+ */
+inline void prefetch(const void *address)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(address);
+#else
+  (void)address;
+#endif
+}
+
+/**
+ * Prints each element from `vector` to `std::cout` in JSON format, as
+ * `BufferedWriter::write_json` formats them.
  */
 template <typename T>
 void print_vector(const std::span<const T> vector, bool breakline = true)
 {
-  std::cout << "[";
-
-  auto iterator = vector.begin();
-  const auto last_element = std::next(vector.end(), -1);
-  while (iterator != vector.end())
-  {
-    std::cout << std::to_string(*iterator);
-    if (iterator != last_element) std::cout << ", ";
-    iterator = std::next(iterator);
-  }
-
-  std::cout << "]";
-  if (breakline) std::cout << "\n";
+  // short vectors don't need a buffer as large as the default one.
+  const auto capacity = std::min<size_t>(vector.size() * 24 + 4, 1 << 20);
+  auto writer = BufferedWriter(std::cout, capacity);
+  writer.write_json(vector);
+  if (breakline) writer.write('\n');
 }
 
+/**
+ * Generates `size` ints uniform over [0, max), throwing a
+ * `std::invalid_argument` unless `max` is between 1 and 2^31, so that every
+ * number fits an `int`. See `Generator::uniform`.
+ */
 std::vector<int> generate_random_ints_vector(size_t size, size_t seed,
-                                             size_t max);
+                                             size_t max) noexcept(false);
 
+/**
+ * Generates the ints from 0 up to `size` in a random order. See
+ * `Generator::permutation`.
+ */
 std::vector<int> generate_distinct_shuffled_ints_vector(size_t size,
                                                         size_t seed);
 } // namespace core::utils
@@ -0,0 +1,269 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace core::utils
+{
+
+/**
+ * Formats text into a large buffer that is handed to `output` with a single
+ * `write` once it's full, rather than piece by piece. Numbers are formatted
+ * by `std::to_chars` straight into the buffer, without temporary strings.
+ *
+ * Whatever is still buffered is written when the writer is destroyed, or
+ * explicitly by `flush`.
+ */
+class BufferedWriter
+{
+private:
+  /// The most characters `std::to_chars` takes for any arithmetic type.
+  static constexpr size_t max_number_length = 64;
+
+  std::ostream &output;
+  /// Left uninitialized, as it's only ever read after being written.
+  std::unique_ptr<char[]> buffer;
+  size_t capacity;
+  size_t used = 0;
+
+  /**
+   * Makes room for `length` more characters, flushing if needed.
+   */
+  char *reserve(size_t length)
+  {
+    if (this->capacity - this->used < length) this->flush();
+    return this->buffer.get() + this->used;
+  }
+
+  /**
+   * Writes every integer in `values`, each followed by `suffix` and all but
+   * the first preceded by `separator`. It's the hot path: each integer goes
+   * straight into the buffer, checking for room only once.
+   */
+  template <typename T>
+  void write_integers(std::span<const T> values, std::string_view separator,
+                      std::string_view suffix)
+  {
+    // chars are written as numbers, as `std::to_string` does.
+    using Integer = std::conditional_t<std::same_as<T, char>, int, T>;
+    const auto room = max_number_length + separator.size() + suffix.size();
+
+    for (size_t i = 0; i < values.size(); i++)
+    {
+      char *start = this->reserve(room);
+      char *position = start;
+      if (i > 0) position += separator.copy(position, separator.size());
+      position = std::to_chars(position, position + max_number_length,
+                               (Integer)values[i])
+                     .ptr;
+      position += suffix.copy(position, suffix.size());
+      this->used += position - start;
+    }
+  }
+
+  template <typename T> void write_json_value(const T &value)
+  {
+    if constexpr (std::is_convertible_v<const T &, std::string_view>)
+    {
+      this->write_json_string(value);
+    }
+    else if constexpr (std::is_floating_point_v<T>)
+    {
+      // JSON has no infinities nor NaN.
+      if (std::isfinite(value)) this->write(value);
+      else this->write(std::string_view("null"));
+    }
+    else
+    {
+      this->write(value);
+    }
+  }
+
+  void write_json_string(std::string_view text)
+  {
+    static constexpr char hex[] = "0123456789abcdef";
+
+    this->write('"');
+    for (const char character : text)
+    {
+      switch (character)
+      {
+      case '"': this->write(std::string_view("\\\"")); break;
+      case '\\': this->write(std::string_view("\\\\")); break;
+      case '\n': this->write(std::string_view("\\n")); break;
+      case '\r': this->write(std::string_view("\\r")); break;
+      case '\t': this->write(std::string_view("\\t")); break;
+      default:
+        if ((unsigned char)character >= 0x20)
+        {
+          this->write(character);
+          break;
+        }
+        this->write(std::string_view("\\u00"));
+        this->write(hex[character >> 4]);
+        this->write(hex[character & 0xF]);
+      }
+    }
+    this->write('"');
+  }
+
+  template <typename T> void write_csv_value(const T &value, char separator)
+  {
+    if constexpr (std::is_convertible_v<const T &, std::string_view>)
+    {
+      // fields holding separators, quotes or line breaks are quoted, and
+      // their quotes doubled (RFC 4180).
+      const auto text = std::string_view(value);
+      const auto special = std::string_view("\"\r\n");
+      if (text.find_first_of(special) == std::string_view::npos &&
+          text.find(separator) == std::string_view::npos)
+      {
+        this->write(text);
+        return;
+      }
+
+      this->write('"');
+      for (const char character : text)
+      {
+        if (character == '"') this->write('"');
+        this->write(character);
+      }
+      this->write('"');
+    }
+    else
+    {
+      this->write(value);
+    }
+  }
+
+public:
+  /**
+   * @param capacity How many characters are buffered between writes.
+   */
+  BufferedWriter(std::ostream &output = std::cout, size_t capacity = 1 << 20)
+      : output(output), capacity(std::max(capacity, max_number_length))
+  {
+    this->buffer = std::unique_ptr<char[]>(new char[this->capacity]);
+  }
+
+  BufferedWriter(const BufferedWriter &) = delete;
+  BufferedWriter &operator=(const BufferedWriter &) = delete;
+
+  ~BufferedWriter() { this->flush(); }
+
+  /**
+   * Writes whatever is buffered to the output.
+   */
+  void flush()
+  {
+    if (this->used == 0) return;
+    this->output.write(this->buffer.get(), (std::streamsize)this->used);
+    this->used = 0;
+  }
+
+  BufferedWriter &write(char character)
+  {
+    *this->reserve(1) = character;
+    this->used++;
+    return *this;
+  }
+
+  BufferedWriter &write(std::string_view text)
+  {
+    if (text.size() > this->capacity)
+    {
+      // it would be copied just to be written right away.
+      this->flush();
+      this->output.write(text.data(), (std::streamsize)text.size());
+      return *this;
+    }
+
+    auto *position = this->reserve(text.size());
+    text.copy(position, text.size());
+    this->used += text.size();
+    return *this;
+  }
+
+  BufferedWriter &write(const char *text)
+  {
+    return this->write(std::string_view(text));
+  }
+
+  BufferedWriter &write(bool value)
+  {
+    return this->write(std::string_view(value ? "true" : "false"));
+  }
+
+  /**
+   * Writes `value` as `std::to_chars` formats it, which is the shortest
+   * representation that reads back the same for floating-point numbers.
+   */
+  template <typename T>
+    requires(std::is_arithmetic_v<T> && !std::same_as<T, bool> &&
+             !std::same_as<T, char>)
+  BufferedWriter &write(T value)
+  {
+    auto *position = this->reserve(max_number_length);
+    const auto result =
+        std::to_chars(position, position + max_number_length, value);
+    this->used += result.ptr - position;
+    return *this;
+  }
+
+  /**
+   * Writes `values` as a JSON array, such as `[1, 2, 3]`. Strings are
+   * quoted and escaped.
+   */
+  template <typename T> BufferedWriter &write_json(std::span<const T> values)
+  {
+    this->write('[');
+
+    if constexpr (std::is_integral_v<T> && !std::same_as<T, bool>)
+    {
+      this->write_integers(values, ", ", "");
+    }
+    else
+    {
+      for (size_t i = 0; i < values.size(); i++)
+      {
+        if (i > 0) this->write(std::string_view(", "));
+        this->write_json_value(values[i]);
+      }
+    }
+
+    return this->write(']');
+  }
+
+  /**
+   * Writes `values` as a single CSV column, one record per line. Strings are
+   * quoted whenever they hold `separator`, quotes or line breaks.
+   */
+  template <typename T>
+  BufferedWriter &write_csv(std::span<const T> values, char separator = ',')
+  {
+    if constexpr (std::is_integral_v<T> && !std::same_as<T, bool>)
+    {
+      this->write_integers(values, "", "\n");
+    }
+    else
+    {
+      for (const auto &value : values)
+      {
+        this->write_csv_value(value, separator);
+        this->write('\n');
+      }
+    }
+
+    return *this;
+  }
+};
+
+} // namespace core::utils
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "utils/mapped_file.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace core::utils
+{
+
+/**
+ * The types of the elements a column file may hold.
+ */
+enum class ColumnType : uint32_t
+{
+  Int32,
+  Int64,
+  UInt32,
+  UInt64,
+  Float32,
+  Float64,
+};
+
+/**
+ * The `ColumnType` of `T`, failing to compile if column files can't hold it.
+ */
+template <typename T> constexpr ColumnType column_type_of()
+{
+  if constexpr (std::is_same_v<T, int32_t>) return ColumnType::Int32;
+  else if constexpr (std::is_same_v<T, int64_t>) return ColumnType::Int64;
+  else if constexpr (std::is_same_v<T, uint32_t>) return ColumnType::UInt32;
+  else if constexpr (std::is_same_v<T, uint64_t>) return ColumnType::UInt64;
+  else if constexpr (std::is_same_v<T, float>) return ColumnType::Float32;
+  else if constexpr (std::is_same_v<T, double>) return ColumnType::Float64;
+  else static_assert(sizeof(T) == 0, "Column files can't hold this type.");
+}
+
+/**
+ * The size in bytes of each element of `type`.
+ */
+size_t size_of(ColumnType type) noexcept(false);
+
+/**
+ * The name of `type`, as accepted by `parse_column_type`: "int32", "int64",
+ * "uint32", "uint64", "float32" or "float64".
+ */
+std::string_view name_of(ColumnType type) noexcept(false);
+
+/**
+ * The `ColumnType` called `name`, throwing a `std::invalid_argument` if
+ * there's none.
+ */
+ColumnType parse_column_type(std::string_view name) noexcept(false);
+
+namespace internal
+{
+
+/**
+ * The first bytes of a column file. Like hash table snapshots, column files
+ * are written in the machine's own byte order, so they may only be read back
+ * on the same architecture.
+ */
+struct ColumnHeader
+{
+  char magic[8];
+  uint32_t version;
+  ColumnType type;
+  uint32_t element_size;
+  uint32_t reserved;
+  uint64_t count;
+  /// Where the elements begin, counting from the start of the file.
+  uint64_t payload_offset;
+};
+
+constexpr char column_magic[8] = {'A', 'E', 'D', '2', 'C', 'O', 'L', 'F'};
+constexpr uint32_t column_version = 1;
+/// Mappings start at a page boundary, so the elements are aligned to a cache
+/// line in memory as well.
+constexpr uint64_t column_payload_alignment = 64;
+
+} // namespace internal
+
+/**
+ * Writes `count` elements of `type` from `data` as a column file at `path`,
+ * replacing it. The elements are handed to the OS in a few large sequential
+ * writes rather than element by element.
+ *
+ * Throws a `std::runtime_error` if the file can't be written.
+ */
+void write_column_file(const std::string &path, ColumnType type,
+                       const void *data, size_t count) noexcept(false);
+
+template <typename T>
+void write_column_file(const std::string &path,
+                       std::span<const T> values) noexcept(false)
+{
+  write_column_file(path, column_type_of<T>(), values.data(), values.size());
+}
+
+/**
+ * A column file mapped into memory: opening it only validates its header,
+ * and its elements are served straight from the mapping, without copying
+ * nor deserializing them.
+ */
+class ColumnFile
+{
+private:
+  MappedFile file;
+  ColumnType _type;
+  size_t _size;
+  const std::byte *payload;
+
+public:
+  /**
+   * Maps the column file at `path`, throwing a `std::runtime_error` if it
+   * can't be mapped or isn't a valid column file.
+   */
+  ColumnFile(const std::string &path) noexcept(false);
+
+  ColumnType type() const { return this->_type; }
+  size_t size() const { return this->_size; }
+
+  /**
+   * The file's elements, throwing a `std::runtime_error` if they aren't of
+   * type `T`. The span is only valid while the file is.
+   */
+  template <typename T> std::span<const T> values() const noexcept(false)
+  {
+    if (column_type_of<T>() != this->_type)
+    {
+      throw std::runtime_error("Column file holds " +
+                               std::string(name_of(this->_type)) +
+                               ", not " +
+                               std::string(name_of(column_type_of<T>())));
+    }
+
+    return std::span(reinterpret_cast<const T *>(this->payload), this->_size);
+  }
+};
+
+} // namespace core::utils
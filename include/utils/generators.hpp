@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace core::utils
+{
+
+/**
+ * Generates data sets deterministically from a seed, in parallel.
+ *
+ * It's counter-based: the `i`-th random number of a seed is computed from
+ * `i` alone, as the `i`-th output of SplitMix64, rather than from the ones
+ * before it. Thus every element is generated independently, the output is
+ * the same whatever the thread count, and generators may be shared between
+ * threads.
+ */
+class Generator
+{
+private:
+  uint64_t seed;
+  size_t threads;
+
+public:
+  /**
+   * @param threads How many threads to fill data sets with, or 0 to use the
+   * hardware concurrency. Small data sets are filled on the calling thread.
+   */
+  Generator(uint64_t seed, size_t threads = 0) : seed(seed), threads(threads)
+  {
+  }
+
+  /**
+   * The random number at `index`, uniform over every 64-bit value.
+   */
+  uint64_t at(uint64_t index) const
+  {
+    uint64_t z = this->seed + (index + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+
+  /**
+   * The random number at `index`, uniform over [0, bound), without modulo
+   * bias (Lemire, "Fast Random Integer Generation in an Interval").
+   */
+  uint64_t at(uint64_t index, uint64_t bound) const;
+
+  /**
+   * Numbers uniform over every 64-bit value.
+   */
+  std::vector<uint64_t> uniform(size_t size) const;
+
+  /**
+   * Numbers uniform over [0, bound), throwing a `std::invalid_argument` if
+   * `bound` is 0.
+   */
+  std::vector<uint64_t> uniform(size_t size, uint64_t bound) const
+      noexcept(false);
+
+  /**
+   * Ranks in [0, n) whose popularity follows Zipf's law with exponent
+   * `theta`, as YCSB draws them (Gray et al., "Quickly Generating
+   * Billion-Record Synthetic Databases"). Rank 0 is the most popular.
+   */
+  std::vector<uint64_t> zipfian(size_t size, uint64_t n,
+                                double theta = 0.99) const noexcept(false);
+
+  /**
+   * Numbers normally distributed around `mean`, by the Box-Muller transform.
+   */
+  std::vector<double> normal(size_t size, double mean = 0,
+                             double stddev = 1) const;
+
+  /**
+   * The numbers from 0 up to `size` in a random order.
+   */
+  std::vector<uint64_t> permutation(size_t size) const;
+
+  /**
+   * The numbers from 0 up to `size`, in increasing order.
+   */
+  std::vector<uint64_t> sorted(size_t size) const;
+
+  /**
+   * The numbers from `size` down to 1, in decreasing order.
+   */
+  std::vector<uint64_t> reversed(size_t size) const;
+
+  /**
+   * Increasing runs of `run_length` consecutive numbers, each starting at a
+   * random number below `size`, as partially sorted input does.
+   */
+  std::vector<uint64_t> runs(size_t size, size_t run_length) const
+      noexcept(false);
+
+  /**
+   * Numbers drawn uniformly from only `unique_count` distinct random ones.
+   */
+  std::vector<uint64_t> few_unique(size_t size, size_t unique_count) const
+      noexcept(false);
+};
+
+} // namespace core::utils
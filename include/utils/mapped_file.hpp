@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+
+namespace core::utils
+{
+
+/**
+ * A read-only, shared memory mapping of a whole file, which is unmapped once
+ * it goes out of scope. Its pages are loaded lazily and shared with every
+ * other process mapping the same file.
+ */
+class MappedFile
+{
+private:
+  const std::byte *data;
+  size_t length;
+
+public:
+  /**
+   * Maps the file at `path`, throwing a `std::runtime_error` if it can't be
+   * opened or mapped.
+   */
+  MappedFile(const std::string &path) noexcept(false);
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  std::span<const std::byte> bytes() const
+  {
+    return std::span(this->data, this->length);
+  }
+
+  size_t size() const { return this->length; }
+};
+
+} // namespace core::utils
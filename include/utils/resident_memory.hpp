@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+
+namespace core::utils
+{
+
+/**
+ * How many bytes of the process' memory are resident right now, or 0 if the
+ * platform doesn't tell.
+ */
+size_t current_rss();
+
+/**
+ * The most bytes of the process' memory that have been resident at once,
+ * since it started or since the last `reset_peak_rss()`.
+ */
+size_t peak_rss();
+
+/**
+ * Releases the memory the allocator is holding on to, and makes `peak_rss()`
+ * start over from the current resident memory.
+ *
+ * @returns Whether the peak could be reset, which is only supported on Linux.
+ * Elsewhere, the peak keeps counting since the process started.
+ */
+bool reset_peak_rss();
+
+} // namespace core::utils
@@ -1,33 +1,355 @@
 #include "hash_table.hpp"
+#include "sort_algorithms.hpp"
 #include "utils.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
 #include <iostream>
+#include <map>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
 
-int main(/* int argc, char **argv */)
+namespace
 {
-  auto hash_table = core::hash_table::SCHashTable<int>(7);
 
-  hash_table.insert(0, 1);
-  hash_table.insert(3, 2);
-  hash_table.insert(11, 3);
-  hash_table.insert(12, 4);
-  hash_table.insert(6, 5);
-  hash_table.insert(14, 6);
+using namespace core;
+using utils::ColumnType;
 
-  hash_table.remove(14);
-  hash_table.remove(14);
+constexpr char usage[] = R"(Usage: estrutura-de-dados <command> [options]
 
-  for (size_t i = 0; i < 15; i++)
+Runs the library's algorithms over column files, binary files holding a
+single column of numbers (see `core::utils::ColumnFile`).
+
+Commands:
+  generate <output> --count <n> [--type <type>] [--seed <n>]
+           [--distribution <distribution>]
+      Writes <n> numbers. Distributions: uniform (default), permutation,
+      sorted, reversed, runs, few-unique and zipfian.
+  sort <input> <output> [--algorithm <algorithm>]
+      Sorts the numbers. Algorithms: quick (default), merge, iterative-merge,
+      insertion, selection and std.
+  dedup <input> <output> [--algorithm <algorithm>]
+      Drops repeated numbers. With hash (default) the first occurrences keep
+      their order, with any sorting algorithm they're sorted.
+  index <input> <output> [--probing <probing>]
+      Saves an `OAHashTable` snapshot mapping each number to the position of
+      its first occurrence. Probing: linear (default), quadratic and double.
+  print <input>
+      Prints the numbers as a JSON array.
+
+Types: int32, int64 (default), uint32, uint64, float32 and float64.
+)";
+
+constexpr std::string_view sort_algorithms[] = {
+    "quick", "merge", "iterative-merge", "insertion", "selection", "std"};
+
+/**
+ * The command line, split into positional arguments and `--name value`
+ * options.
+ */
+struct Arguments
+{
+  std::string command;
+  std::vector<std::string> paths;
+  std::map<std::string, std::string, std::less<>> options;
+
+  std::string option(std::string_view name, std::string_view fallback) const
   {
-    std::cout << "hash_table[" << i << "] = ";
-    auto value = hash_table.get(i);
+    const auto option = this->options.find(name);
+    return std::string(option == this->options.end() ? fallback
+                                                     : option->second);
+  }
 
-    if (value)
+  uint64_t number_option(std::string_view name, uint64_t fallback) const
+  {
+    const auto option = this->options.find(name);
+    if (option == this->options.end()) return fallback;
+
+    const auto &text = option->second;
+    uint64_t number;
+    const auto result =
+        std::from_chars(text.data(), text.data() + text.size(), number);
+    if (result.ec != std::errc() || result.ptr != text.data() + text.size())
     {
-      std::cout << *value << ";\n";
+      throw std::invalid_argument("--" + std::string(name) +
+                                  " must be a number");
+    }
+    return number;
+  }
+
+  /**
+   * Throws a `std::invalid_argument` unless there are exactly `paths_count`
+   * paths and no options other than `allowed`.
+   */
+  void expect(size_t paths_count,
+              std::initializer_list<std::string_view> allowed) const
+  {
+    if (this->paths.size() != paths_count)
+    {
+      throw std::invalid_argument(this->command + " takes " +
+                                  std::to_string(paths_count) + " paths");
+    }
+
+    for (const auto &[name, value] : this->options)
+    {
+      if (std::ranges::find(allowed, name) == allowed.end())
+      {
+        throw std::invalid_argument(this->command + " takes no --" + name);
+      }
+    }
+  }
+};
+
+Arguments parse_arguments(int argc, char **argv)
+{
+  if (argc < 2) throw std::invalid_argument("Missing command");
+
+  auto arguments = Arguments();
+  arguments.command = argv[1];
+  for (int i = 2; i < argc; i++)
+  {
+    const auto argument = std::string_view(argv[i]);
+    if (!argument.starts_with("--"))
+    {
+      arguments.paths.emplace_back(argument);
       continue;
     }
+    if (i + 1 == argc)
+    {
+      throw std::invalid_argument(std::string(argument) + " needs a value");
+    }
+    arguments.options.insert_or_assign(std::string(argument.substr(2)),
+                                       argv[++i]);
+  }
+
+  return arguments;
+}
+
+/**
+ * Calls `f` with a value of the C++ type of `type`, so that it can be written
+ * once for every type.
+ */
+template <typename F> void visit(ColumnType type, F &&f)
+{
+  switch (type)
+  {
+  case ColumnType::Int32: return f(int32_t());
+  case ColumnType::Int64: return f(int64_t());
+  case ColumnType::UInt32: return f(uint32_t());
+  case ColumnType::UInt64: return f(uint64_t());
+  case ColumnType::Float32: return f(float());
+  case ColumnType::Float64: return f(double());
+  }
+}
+
+template <typename T> void sort(std::span<T> values, std::string_view algorithm)
+{
+  using namespace core::sort_algorithms;
+
+  if (algorithm == "quick") quick_sort(values);
+  else if (algorithm == "merge") merge_sort(values);
+  else if (algorithm == "iterative-merge") iteratively_merge_sort(values);
+  else if (algorithm == "insertion") insertion_sort(values);
+  else if (algorithm == "selection") selection_sort(values);
+  else if (algorithm == "std") std::ranges::sort(values);
+}
+
+void expect_sort_algorithm(std::string_view algorithm)
+{
+  if (std::ranges::count(sort_algorithms, algorithm) == 0)
+  {
+    throw std::invalid_argument("Unknown algorithm \"" +
+                                std::string(algorithm) + "\"");
+  }
+}
+
+void generate(const Arguments &arguments)
+{
+  arguments.expect(1, {"count", "type", "seed", "distribution"});
+
+  if (!arguments.options.contains("count"))
+  {
+    throw std::invalid_argument("generate needs --count");
+  }
+
+  const auto count = arguments.number_option("count", 0);
+  const auto type = utils::parse_column_type(arguments.option("type", "int64"));
+  const auto distribution = arguments.option("distribution", "uniform");
+  const auto generator = utils::Generator(arguments.number_option("seed", 0));
+
+  std::vector<uint64_t> numbers;
+  if (distribution == "uniform") numbers = generator.uniform(count);
+  else if (distribution == "permutation")
+  {
+    numbers = generator.permutation(count);
+  }
+  else if (distribution == "sorted") numbers = generator.sorted(count);
+  else if (distribution == "reversed") numbers = generator.reversed(count);
+  else if (distribution == "runs") numbers = generator.runs(count, 64);
+  else if (distribution == "few-unique")
+  {
+    numbers = generator.few_unique(count, 16);
+  }
+  else if (distribution == "zipfian")
+  {
+    numbers = generator.zipfian(count, std::max<uint64_t>(count, 1));
+  }
+  else
+  {
+    throw std::invalid_argument("Unknown distribution \"" + distribution +
+                                "\"");
+  }
+
+  visit(type,
+        [&]<typename T>(T)
+        {
+          // uniform numbers fill the whole 64 bits, so they're truncated to
+          // fit narrower types.
+          auto values = std::vector<T>(numbers.begin(), numbers.end());
+          utils::write_column_file(arguments.paths[0],
+                                   std::span<const T>(values));
+        });
+}
+
+void sort(const Arguments &arguments)
+{
+  arguments.expect(2, {"algorithm"});
+  const auto algorithm = arguments.option("algorithm", "quick");
+  expect_sort_algorithm(algorithm);
+
+  const auto input = utils::ColumnFile(arguments.paths[0]);
+  visit(input.type(),
+        [&]<typename T>(T)
+        {
+          // the mapping is read-only, so the elements are sorted in a copy.
+          const auto mapped = input.values<T>();
+          auto values = std::vector<T>(mapped.begin(), mapped.end());
+          sort(std::span(values), algorithm);
+          utils::write_column_file(arguments.paths[1],
+                                   std::span<const T>(values));
+        });
+}
+
+void dedup(const Arguments &arguments)
+{
+  arguments.expect(2, {"algorithm"});
+  const auto algorithm = arguments.option("algorithm", "hash");
+  if (algorithm != "hash") expect_sort_algorithm(algorithm);
+
+  const auto input = utils::ColumnFile(arguments.paths[0]);
+  visit(input.type(),
+        [&]<typename T>(T)
+        {
+          const auto mapped = input.values<T>();
+          std::vector<T> values;
+
+          if (algorithm == "hash")
+          {
+            // the elements are read straight from the mapping.
+            auto seen = hash_table::DenseHashTable<char, T>(mapped.size());
+            for (const auto value : mapped)
+            {
+              if (seen.try_emplace(value, 0).second) values.push_back(value);
+            }
+          }
+          else
+          {
+            values.assign(mapped.begin(), mapped.end());
+            sort(std::span(values), algorithm);
+            values.erase(std::unique(values.begin(), values.end()),
+                         values.end());
+          }
+
+          utils::write_column_file(arguments.paths[1],
+                                   std::span<const T>(values));
+        });
+}
+
+template <typename T, typename Probing>
+void save_index(std::span<const T> values, const std::string &path)
+{
+  auto index = hash_table::OAHashTable<uint64_t, T, hash_table::Hash<T>,
+                                       Probing>(16);
+  index.reserve(values.size());
+
+  for (size_t position = 0; position < values.size(); position++)
+  {
+    index.try_emplace(values[position], position);
+  }
 
-    std::cout << "undefined;\n";
+  index.save(path);
+}
+
+void index(const Arguments &arguments)
+{
+  arguments.expect(2, {"probing"});
+  const auto probing = arguments.option("probing", "linear");
+  if (probing != "linear" && probing != "quadratic" && probing != "double")
+  {
+    throw std::invalid_argument("Unknown probing \"" + probing + "\"");
+  }
+
+  const auto input = utils::ColumnFile(arguments.paths[0]);
+  visit(input.type(),
+        [&]<typename T>(T)
+        {
+          using namespace core::hash_table;
+
+          const auto values = input.values<T>();
+          const auto &output = arguments.paths[1];
+          if (probing == "linear") save_index<T, LinearProbing>(values, output);
+          else if (probing == "quadratic")
+          {
+            save_index<T, QuadraticProbing>(values, output);
+          }
+          else save_index<T, DoubleHashing>(values, output);
+        });
+}
+
+void print(const Arguments &arguments)
+{
+  arguments.expect(1, {});
+
+  const auto input = utils::ColumnFile(arguments.paths[0]);
+  visit(input.type(),
+        [&]<typename T>(T) { utils::print_vector(input.values<T>()); });
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  try
+  {
+    const auto arguments = parse_arguments(argc, argv);
+
+    if (arguments.command == "generate") generate(arguments);
+    else if (arguments.command == "sort") sort(arguments);
+    else if (arguments.command == "dedup") dedup(arguments);
+    else if (arguments.command == "index") index(arguments);
+    else if (arguments.command == "print") print(arguments);
+    else if (arguments.command == "help" || arguments.command == "--help")
+    {
+      std::cout << usage;
+    }
+    else
+    {
+      throw std::invalid_argument("Unknown command \"" + arguments.command +
+                                  "\"");
+    }
+  }
+  catch (const std::invalid_argument &error)
+  {
+    std::cerr << error.what() << "\n\n" << usage;
+    return 2;
+  }
+  catch (const std::exception &error)
+  {
+    std::cerr << error.what() << '\n';
+    return 1;
   }
 
   return 0;
@@ -1,52 +1,29 @@
 #include "utils.hpp"
-#include <iostream>
+#include <limits>
+#include <stdexcept>
 
 namespace core::utils
 {
 std::vector<int> generate_random_ints_vector(size_t size, size_t seed,
                                              size_t max)
 {
-  auto vec = std::vector<int>();
-  vec.reserve(size);
-
-  srand(seed);
-  for (size_t i = 0; i < size; i++)
+  // greater numbers would wrap around to negative ints.
+  const auto max_int = (size_t)std::numeric_limits<int>::max() + 1;
+  if (max == 0 || max > max_int)
   {
-    // Same behavior as val = val > max ? val : val - max.
-    vec.push_back(rand() % max);
+    throw std::invalid_argument("Max must be between 1 and 2^31");
   }
 
-  return vec;
-}
-
-static void shuffle(std::span<int> list, size_t seed)
-{
-  srand(seed);
-
-  const auto size = list.size();
-  if (size <= 1) return;
-
-  for (size_t i = 0; i < size - 1; i++)
-  {
-    const size_t random_index = i + rand() / (RAND_MAX / (size - i) + 1);
-    auto temp = list[random_index];
-    list[random_index] = list[i];
-    list[i] = temp;
-  }
+  const auto generator = Generator(seed);
+  auto numbers = std::vector<int>(size);
+  for (size_t i = 0; i < size; i++) numbers[i] = (int)generator.at(i, max);
+  return numbers;
 }
 
 std::vector<int> generate_distinct_shuffled_ints_vector(size_t size,
                                                         size_t seed)
 {
-  auto vec = std::vector<int>();
-  vec.reserve(size);
-
-  for (size_t i = 0; i < size; i++)
-  {
-    vec.push_back(i);
-  }
-
-  shuffle(vec, seed);
-  return vec;
+  const auto numbers = Generator(seed).permutation(size);
+  return std::vector<int>(numbers.begin(), numbers.end());
 }
 } // namespace core::utils
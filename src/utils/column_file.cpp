@@ -0,0 +1,139 @@
+#include "utils/column_file.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace core::utils
+{
+
+/// The most bytes handed to the OS by a single write. Large enough that
+/// writes cost a handful of system calls, small enough not to stall on one.
+static constexpr size_t write_chunk_size = 1 << 23;
+
+size_t size_of(ColumnType type)
+{
+  switch (type)
+  {
+  case ColumnType::Int32:
+  case ColumnType::UInt32:
+  case ColumnType::Float32: return 4;
+  case ColumnType::Int64:
+  case ColumnType::UInt64:
+  case ColumnType::Float64: return 8;
+  }
+
+  throw std::invalid_argument("Unknown column type");
+}
+
+std::string_view name_of(ColumnType type)
+{
+  switch (type)
+  {
+  case ColumnType::Int32: return "int32";
+  case ColumnType::Int64: return "int64";
+  case ColumnType::UInt32: return "uint32";
+  case ColumnType::UInt64: return "uint64";
+  case ColumnType::Float32: return "float32";
+  case ColumnType::Float64: return "float64";
+  }
+
+  throw std::invalid_argument("Unknown column type");
+}
+
+ColumnType parse_column_type(std::string_view name)
+{
+  for (const auto type : {ColumnType::Int32, ColumnType::Int64,
+                          ColumnType::UInt32, ColumnType::UInt64,
+                          ColumnType::Float32, ColumnType::Float64})
+  {
+    if (name_of(type) == name) return type;
+  }
+
+  throw std::invalid_argument("Unknown column type \"" + std::string(name) +
+                              "\"");
+}
+
+void write_column_file(const std::string &path, ColumnType type,
+                       const void *data, size_t count)
+{
+  using namespace internal;
+
+  auto file = std::ofstream(path, std::ios::binary | std::ios::trunc);
+  if (!file) throw std::runtime_error("Could not open \"" + path + "\"");
+
+  ColumnHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, column_magic, sizeof(column_magic));
+  header.version = column_version;
+  header.type = type;
+  header.element_size = size_of(type);
+  header.count = count;
+  header.payload_offset = (sizeof(header) + column_payload_alignment - 1) /
+                          column_payload_alignment * column_payload_alignment;
+
+  auto padded_header = std::vector<char>(header.payload_offset, 0);
+  std::memcpy(padded_header.data(), &header, sizeof(header));
+  file.write(padded_header.data(), padded_header.size());
+
+  // the elements are already laid out as the file wants them, so they're
+  // written straight from `data`, without being copied first.
+  const auto *bytes = static_cast<const char *>(data);
+  const auto length = count * header.element_size;
+  for (size_t offset = 0; offset < length && file; offset += write_chunk_size)
+  {
+    file.write(bytes + offset, std::min(write_chunk_size, length - offset));
+  }
+
+  file.flush();
+  if (!file) throw std::runtime_error("Could not write \"" + path + "\"");
+}
+
+static std::runtime_error invalid(const std::string &reason)
+{
+  return std::runtime_error("Invalid column file: " + reason);
+}
+
+ColumnFile::ColumnFile(const std::string &path) : file(path)
+{
+  using namespace internal;
+
+  const auto bytes = this->file.bytes();
+  if (bytes.size() < sizeof(ColumnHeader)) throw invalid("too short");
+
+  ColumnHeader header;
+  std::memcpy(&header, bytes.data(), sizeof(header));
+
+  if (std::memcmp(header.magic, column_magic, sizeof(column_magic)))
+  {
+    throw invalid("not a column file");
+  }
+  if (header.version != column_version)
+  {
+    throw invalid("unsupported version " + std::to_string(header.version));
+  }
+
+  size_t element_size;
+  try
+  {
+    element_size = size_of(header.type);
+  }
+  catch (const std::invalid_argument &)
+  {
+    throw invalid("unknown element type");
+  }
+
+  if (header.element_size != element_size ||
+      header.payload_offset % column_payload_alignment != 0 ||
+      header.payload_offset > bytes.size() ||
+      (bytes.size() - header.payload_offset) / element_size < header.count)
+  {
+    throw invalid("corrupted header");
+  }
+
+  this->_type = header.type;
+  this->_size = header.count;
+  this->payload = bytes.data() + header.payload_offset;
+}
+
+} // namespace core::utils
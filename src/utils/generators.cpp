@@ -0,0 +1,206 @@
+#include "utils/generators.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+#include <thread>
+
+namespace core::utils
+{
+
+/// The fewest elements worth a thread of their own.
+static constexpr size_t min_elements_per_thread = 1 << 14;
+
+/**
+ * Sets each `output[i]` to `f(i)`, splitting the indices into contiguous
+ * chunks, one for each thread.
+ */
+template <typename T, typename F>
+static std::vector<T> fill(size_t size, size_t threads, F &&f)
+{
+  auto output = std::vector<T>(size);
+
+  if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+  threads = std::clamp<size_t>(size / min_elements_per_thread, 1, threads);
+
+  const auto fill_chunk = [&](size_t chunk)
+  {
+    const auto end = size * (chunk + 1) / threads;
+    for (size_t i = size * chunk / threads; i < end; i++) output[i] = f(i);
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t chunk = 1; chunk < threads; chunk++)
+  {
+    workers.emplace_back(fill_chunk, chunk);
+  }
+  fill_chunk(0);
+  for (auto &worker : workers) worker.join();
+
+  return output;
+}
+
+/**
+ * Maps 64 random bits to a double uniform over (0, 1].
+ */
+static double unit_interval(uint64_t random)
+{
+  return (double)((random >> 11) + 1) * 0x1.0p-53;
+}
+
+uint64_t Generator::at(uint64_t index, uint64_t bound) const
+{
+  auto random = this->at(index);
+  // the low half of the product is below `threshold` for the few values
+  // that would make some numbers likelier, which are drawn again.
+  const auto threshold = -bound % bound;
+
+  while (true)
+  {
+    const auto product = (unsigned __int128)random * bound;
+    if ((uint64_t)product >= threshold) return (uint64_t)(product >> 64);
+
+    // redraws deterministically, from the rejected number.
+    random = Generator(random).at(index);
+  }
+}
+
+std::vector<uint64_t> Generator::uniform(size_t size) const
+{
+  return fill<uint64_t>(size, this->threads,
+                        [&](size_t i) { return this->at(i); });
+}
+
+std::vector<uint64_t> Generator::uniform(size_t size, uint64_t bound) const
+{
+  if (bound == 0) throw std::invalid_argument("Bound must be positive");
+
+  return fill<uint64_t>(size, this->threads,
+                        [&](size_t i) { return this->at(i, bound); });
+}
+
+std::vector<uint64_t> Generator::zipfian(size_t size, uint64_t n,
+                                         double theta) const
+{
+  if (n == 0) throw std::invalid_argument("Ranks must not be empty");
+  if (theta <= 0 || theta >= 1)
+  {
+    throw std::invalid_argument("Theta must be between 0 and 1");
+  }
+
+  const auto zeta = [&](uint64_t n)
+  {
+    double sum = 0;
+    for (uint64_t i = 1; i <= n; i++) sum += 1 / std::pow((double)i, theta);
+    return sum;
+  };
+
+  const auto alpha = 1 / (1 - theta);
+  const auto zeta_n = zeta(n);
+  const auto eta = (1 - std::pow(2.0 / (double)n, 1 - theta)) /
+                   (1 - zeta(std::min<uint64_t>(n, 2)) / zeta_n);
+  const auto second = 1 + std::pow(0.5, theta);
+
+  return fill<uint64_t>(
+      size, this->threads,
+      [&](size_t i) -> uint64_t
+      {
+        const auto random = unit_interval(this->at(i)) - 0x1.0p-53;
+        const auto scaled = random * zeta_n;
+        if (scaled < 1) return 0;
+        if (scaled < second) return 1;
+
+        const auto rank =
+            (uint64_t)((double)n * std::pow(eta * random - eta + 1, alpha));
+        return std::min(rank, n - 1);
+      });
+}
+
+std::vector<double> Generator::normal(size_t size, double mean,
+                                      double stddev) const
+{
+  return fill<double>(
+      size, this->threads,
+      [&](size_t i)
+      {
+        // each element takes two numbers of its own.
+        const auto radius =
+            std::sqrt(-2 * std::log(unit_interval(this->at(i * 2))));
+        const auto angle =
+            2 * std::numbers::pi * unit_interval(this->at(i * 2 + 1));
+        return mean + stddev * radius * std::cos(angle);
+      });
+}
+
+std::vector<uint64_t> Generator::permutation(size_t size) const
+{
+  // a Feistel network permutes the numbers of `bits` bits, whatever its
+  // round function. Those beyond `size` are walked past, by permuting them
+  // again until they land within it (Black and Rogaway, "Ciphers with
+  // Arbitrary Finite Domains").
+  const auto half_bits =
+      (std::max<int>(std::bit_width(size > 0 ? size - 1 : 0), 2) + 1) / 2;
+  const auto mask = (uint64_t(1) << half_bits) - 1;
+
+  const auto permute = [&](uint64_t index)
+  {
+    do
+    {
+      auto left = index >> half_bits;
+      auto right = index & mask;
+      for (uint64_t round = 0; round < 4; round++)
+      {
+        const auto next = left ^ (this->at(right + (round << 32)) & mask);
+        left = right;
+        right = next;
+      }
+      index = (left << half_bits) | right;
+    } while (index >= size);
+
+    return index;
+  };
+
+  return fill<uint64_t>(size, this->threads, permute);
+}
+
+std::vector<uint64_t> Generator::sorted(size_t size) const
+{
+  return fill<uint64_t>(size, this->threads, [](size_t i) { return i; });
+}
+
+std::vector<uint64_t> Generator::reversed(size_t size) const
+{
+  return fill<uint64_t>(size, this->threads,
+                        [&](size_t i) { return size - i; });
+}
+
+std::vector<uint64_t> Generator::runs(size_t size, size_t run_length) const
+{
+  if (run_length == 0) throw std::invalid_argument("Runs must not be empty");
+
+  return fill<uint64_t>(size, this->threads,
+                        [&](size_t i)
+                        {
+                          const auto run = i / run_length;
+                          return this->at(run, size) + i % run_length;
+                        });
+}
+
+std::vector<uint64_t> Generator::few_unique(size_t size,
+                                            size_t unique_count) const
+{
+  if (unique_count == 0)
+  {
+    throw std::invalid_argument("There must be some unique numbers");
+  }
+
+  // the unique numbers are taken from another seed, so they don't depend on
+  // the picks.
+  const auto values = Generator(~this->seed);
+  return fill<uint64_t>(size, this->threads,
+                        [&](size_t i)
+                        { return values.at(this->at(i, unique_count)); });
+}
+
+} // namespace core::utils
@@ -0,0 +1,77 @@
+#include "utils/mapped_file.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace core::utils
+{
+
+static std::runtime_error mapping_error(const std::string &path,
+                                        const char *action)
+{
+  return std::runtime_error("Could not " + std::string(action) + " \"" + path +
+                            "\": " + std::strerror(errno));
+}
+
+MappedFile::MappedFile(const std::string &path) : data(nullptr), length(0)
+{
+  const int file = open(path.c_str(), O_RDONLY);
+  if (file < 0) throw mapping_error(path, "open");
+
+  struct stat status;
+  if (fstat(file, &status) < 0)
+  {
+    const auto error = mapping_error(path, "stat");
+    close(file);
+    throw error;
+  }
+
+  this->length = status.st_size;
+
+  // empty files cannot be mapped, but are still valid files.
+  if (this->length == 0)
+  {
+    close(file);
+    return;
+  }
+
+  void *address = mmap(nullptr, this->length, PROT_READ, MAP_SHARED, file, 0);
+  const auto mmap_error = address == MAP_FAILED ? errno : 0;
+  close(file);
+
+  if (mmap_error)
+  {
+    errno = mmap_error;
+    throw mapping_error(path, "map");
+  }
+
+  this->data = static_cast<const std::byte *>(address);
+}
+
+MappedFile::~MappedFile()
+{
+  if (this->data) munmap(const_cast<std::byte *>(this->data), this->length);
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : data(std::exchange(other.data, nullptr)),
+      length(std::exchange(other.length, 0))
+{
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+  if (this == &other) return *this;
+  if (this->data) munmap(const_cast<std::byte *>(this->data), this->length);
+
+  this->data = std::exchange(other.data, nullptr);
+  this->length = std::exchange(other.length, 0);
+  return *this;
+}
+
+} // namespace core::utils
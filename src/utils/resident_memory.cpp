@@ -0,0 +1,86 @@
+#include "utils/resident_memory.hpp"
+#include <fstream>
+#include <string>
+#include <sys/resource.h>
+
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#endif
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace core::utils
+{
+
+#if defined(__linux__)
+/**
+ * Reads a memory field, such as "VmRSS", from /proc/self/status.
+ */
+static size_t status_field(const std::string &name)
+{
+  auto status = std::ifstream("/proc/self/status");
+  const auto prefix = name + ":";
+
+  std::string line;
+  while (std::getline(status, line))
+  {
+    if (line.compare(0, prefix.size(), prefix) != 0) continue;
+    // the field is formatted as "<name>:   <kibibytes> kB".
+    return std::stoull(line.substr(prefix.size())) * 1024;
+  }
+
+  return 0;
+}
+#endif
+
+size_t current_rss()
+{
+#if defined(__linux__)
+  return status_field("VmRSS");
+#elif defined(__APPLE__)
+  mach_task_basic_info info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  const auto result = task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                                (task_info_t)&info, &count);
+  return result == KERN_SUCCESS ? info.resident_size : 0;
+#else
+  return 0;
+#endif
+}
+
+size_t peak_rss()
+{
+#if defined(__linux__)
+  return status_field("VmHWM");
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+  // macOS reports bytes, every other platform reports kibibytes.
+#if defined(__APPLE__)
+  return usage.ru_maxrss;
+#else
+  return usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+bool reset_peak_rss()
+{
+#if defined(__GLIBC__)
+  malloc_trim(0);
+#endif
+
+#if defined(__linux__)
+  // writing 5 to clear_refs resets the peak resident memory (VmHWM).
+  auto clear_refs = std::ofstream("/proc/self/clear_refs");
+  clear_refs << "5";
+  clear_refs.flush();
+  return clear_refs.good();
+#else
+  return false;
+#endif
+}
+
+} // namespace core::utils
@@ -0,0 +1,210 @@
+#include "catch2/catch_all.hpp"
+#include "trees.hpp"
+#include "utils.hpp"
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+/// Draws the keys of random operations.
+const auto random_keys = core::utils::Generator(0);
+/// Draws which random operation to run.
+const auto random_operations = core::utils::Generator(1);
+
+template <typename Tree, typename K, typename V>
+void require_same(const Tree &tree, const std::map<K, V> &map)
+{
+  REQUIRE(tree.count() == map.size());
+
+  auto iterator = tree.begin();
+  for (const auto &[key, value] : map)
+  {
+    REQUIRE(iterator != tree.end());
+    REQUIRE(iterator.key() == key);
+    REQUIRE(iterator.value() == value);
+    iterator++;
+  }
+  REQUIRE(iterator == tree.end());
+}
+
+} // namespace
+
+TEST_CASE("it should be able to correctly insert and get elements",
+          "[BPlusTree, external]")
+{
+  std::vector<std::pair<int, int>> pairs = {
+      std::pair(0, 1),  std::pair(3, 2), std::pair(11, 3),
+      std::pair(12, 4), std::pair(6, 5), std::pair(14, 6)};
+
+  auto tree = core::trees::BPlusTree<int, int>();
+
+  for (const auto &pair : pairs) tree.insert(pair.first, pair.second);
+  tree.insert(14, 3);
+
+  for (const auto &pair : pairs)
+  {
+    const int *element = tree.get(pair.first);
+    REQUIRE(element != nullptr);
+    REQUIRE(*element == (pair.first == 14 ? 3 : pair.second));
+  }
+
+  REQUIRE(tree.get(100) == nullptr);
+  REQUIRE(tree.get(-1) == nullptr);
+  REQUIRE(tree.count() == pairs.size());
+}
+
+TEST_CASE("it should match std::map under random insertions and removals",
+          "[BPlusTree, internal]")
+{
+  // small nodes make for a deep tree, that splits and merges often.
+  auto tree = core::trees::BPlusTree<int64_t, uint64_t, 64>();
+  auto map = std::map<int64_t, uint64_t>();
+
+  for (uint64_t i = 0; i < 100000; i++)
+  {
+    const auto key = (int64_t)random_keys.at(i, 4000) - 2000;
+    if (random_operations.at(i, 5) < 2)
+    {
+      tree.remove(key);
+      map.erase(key);
+    }
+    else
+    {
+      tree.insert(key, i);
+      map.insert_or_assign(key, i);
+    }
+  }
+
+  require_same(tree, map);
+  for (int64_t key = -2000; key < 2000; key++)
+  {
+    const auto iterator = map.find(key);
+    const uint64_t *value = tree.get(key);
+    REQUIRE((value != nullptr) == (iterator != map.end()));
+    if (value) REQUIRE(*value == iterator->second);
+  }
+
+  for (const auto &[key, value] : map) tree.remove(key);
+  REQUIRE(tree.count() == 0);
+  REQUIRE(tree.height() == 0);
+  REQUIRE(tree.begin() == tree.end());
+}
+
+TEST_CASE("it should fill its leaves when keys are inserted in order",
+          "[BPlusTree, internal]")
+{
+  auto tree = core::trees::BPlusTree<uint32_t, uint32_t>();
+  const uint32_t count = 200000;
+
+  for (uint32_t key = 0; key < count; key++) tree.insert(key, key * 3);
+
+  REQUIRE(tree.count() == count);
+  REQUIRE(tree.height() <= 4);
+  // sequential leaves are left full: 60 pairs in each 512 bytes leaf.
+  REQUIRE(tree.memory_usage() < count * 10);
+  for (uint32_t key = 0; key < count; key++) REQUIRE(*tree.get(key) == key * 3);
+}
+
+TEST_CASE("it should scan ranges from lower_bound", "[BPlusTree, external]")
+{
+  auto tree = core::trees::BPlusTree<int, int>();
+  for (int key = 0; key < 10000; key += 2) tree.insert(key, key / 2);
+
+  auto iterator = tree.lower_bound(1001);
+  std::vector<int> keys;
+  for (; iterator != tree.end() && iterator.key() < 1011; iterator++)
+  {
+    keys.push_back((*iterator).first);
+  }
+
+  REQUIRE(keys == std::vector<int>{1002, 1004, 1006, 1008, 1010});
+  REQUIRE(tree.lower_bound(9998).value() == 4999);
+  REQUIRE(tree.lower_bound(9999) == tree.end());
+  REQUIRE(tree.lower_bound(-5).key() == 0);
+}
+
+TEST_CASE("it should bulk load from sorted keys", "[BPlusTree, external]")
+{
+  const size_t count = 100000;
+  std::vector<uint64_t> keys(count);
+  std::vector<uint64_t> values(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    keys[i] = i * 3;
+    values[i] = i;
+  }
+  // the greatest key is also the leaves' padding.
+  keys.back() = std::numeric_limits<uint64_t>::max();
+
+  auto tree = core::trees::BPlusTree<uint64_t, uint64_t>(keys, values);
+
+  REQUIRE(tree.count() == count);
+  for (size_t i = 0; i < count; i++) REQUIRE(*tree.get(keys[i]) == i);
+  REQUIRE(tree.get(1) == nullptr);
+
+  tree.insert(1, 1);
+  tree.remove(keys.back());
+  REQUIRE(*tree.get(1) == 1);
+  REQUIRE(tree.get(keys.back()) == nullptr);
+  REQUIRE(tree.count() == count);
+
+  using Tree = core::trees::BPlusTree<int, int>;
+  const std::vector<int> unsorted = {1, 3, 2};
+  REQUIRE_THROWS_AS(Tree(unsorted, unsorted), std::invalid_argument);
+}
+
+TEST_CASE("it should hold infinite floating-point keys",
+          "[BPlusTree, internal]")
+{
+  const auto infinity = std::numeric_limits<double>::infinity();
+  auto tree = core::trees::BPlusTree<double, int>();
+
+  // more keys than a leaf holds, so that infinities are compared against
+  // padded leaves and inner nodes alike.
+  for (int key = 0; key < 1000; key++) tree.insert(key, key);
+  REQUIRE(tree.get(infinity) == nullptr);
+  REQUIRE(tree.get(-infinity) == nullptr);
+  REQUIRE(tree.lower_bound(infinity) == tree.end());
+
+  tree.insert(infinity, -1);
+  tree.insert(-infinity, -2);
+  REQUIRE(tree.count() == 1002);
+  REQUIRE(*tree.get(infinity) == -1);
+  REQUIRE(*tree.get(-infinity) == -2);
+  REQUIRE(tree.begin().key() == -infinity);
+  REQUIRE(tree.lower_bound(infinity).value() == -1);
+
+  tree.remove(infinity);
+  REQUIRE(tree.get(infinity) == nullptr);
+  REQUIRE(tree.count() == 1001);
+
+  const auto nan = std::numeric_limits<double>::quiet_NaN();
+  REQUIRE_THROWS_AS(tree.insert(nan, 0), std::invalid_argument);
+}
+
+TEST_CASE("it should order string keys", "[BPlusTree, external]")
+{
+  auto tree = core::trees::BPlusTree<std::string, int, 128>();
+  auto map = std::map<std::string, int>();
+
+  for (int i = 0; i < 2000; i++)
+  {
+    const auto key = std::to_string(random_keys.at(i, 1000));
+    tree.insert(key, i);
+    map.insert_or_assign(key, i);
+  }
+  for (int i = 0; i < 300; i++)
+  {
+    const auto key = std::to_string(i);
+    tree.remove(key);
+    map.erase(key);
+  }
+
+  require_same(tree, map);
+}
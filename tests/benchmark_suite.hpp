@@ -0,0 +1,199 @@
+#pragma once
+
+#include "utils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+#include <variant>
+#include <vector>
+
+/*
+ * What the benchmark suites share: their workloads, drawn from
+ * `core::utils::Generator`, how they time operations and how they report
+ * results.
+ */
+
+namespace suite
+{
+
+using Clock = std::chrono::steady_clock;
+
+enum class Distribution
+{
+  Sequential,
+  Uniform,
+  Zipfian,
+};
+
+constexpr Distribution distributions[] = {
+    Distribution::Sequential, Distribution::Uniform, Distribution::Zipfian};
+
+inline const char *name_of(Distribution distribution)
+{
+  switch (distribution)
+  {
+  case Distribution::Sequential: return "sequential";
+  case Distribution::Uniform: return "uniform";
+  case Distribution::Zipfian: return "zipfian";
+  }
+  return "";
+}
+
+/**
+ * The keys of a configuration. Sequential keys are looked up in order; the
+ * others are random, looked up either uniformly or by Zipf's law, the lesser
+ * keys being the most popular. Absent keys are never among the present ones.
+ */
+struct Workload
+{
+  std::vector<uint64_t> keys;
+  std::vector<uint64_t> absent_keys;
+  /// The order in which present keys are looked up.
+  std::vector<uint64_t> lookups;
+
+  /**
+   * @param interleaved Whether sequential absent keys fall between present
+   * ones, rather than after all of them.
+   */
+  Workload(size_t count, Distribution distribution, bool interleaved = false)
+  {
+    const auto generator = core::utils::Generator(0);
+
+    if (distribution == Distribution::Sequential)
+    {
+      this->keys.resize(count);
+      this->absent_keys.resize(count);
+      for (size_t i = 0; i < count; i++)
+      {
+        this->keys[i] = interleaved ? i * 2 : i;
+        this->absent_keys[i] = interleaved ? i * 2 + 1 : count + i;
+      }
+    }
+    else
+    {
+      // the generator's numbers are distinct for distinct indices, so the
+      // second half holds none of the first.
+      this->keys = generator.uniform(count * 2);
+      this->absent_keys.assign(this->keys.begin() + count, this->keys.end());
+      this->keys.resize(count);
+    }
+
+    const auto picks = core::utils::Generator(1);
+    std::vector<uint64_t> ranks;
+    switch (distribution)
+    {
+    case Distribution::Sequential: ranks = picks.sorted(count); break;
+    case Distribution::Uniform: ranks = picks.uniform(count, count); break;
+    case Distribution::Zipfian: ranks = picks.zipfian(count, count); break;
+    }
+
+    auto sorted = this->keys;
+    std::ranges::sort(sorted);
+    this->lookups.resize(count);
+    for (size_t i = 0; i < count; i++) this->lookups[i] = sorted[ranks[i]];
+  }
+};
+
+/**
+ * A measurement, as the fields of a JSON object, in the order they're set.
+ */
+class Result
+{
+private:
+  using Value = std::variant<std::string, size_t, double>;
+
+  std::vector<std::pair<std::string, Value>> fields;
+
+public:
+  template <typename T> Result &set(std::string name, T value)
+  {
+    if constexpr (std::is_convertible_v<T, std::string>)
+    {
+      this->fields.emplace_back(std::move(name), std::string(value));
+    }
+    else if constexpr (std::is_floating_point_v<T>)
+    {
+      this->fields.emplace_back(std::move(name), (double)value);
+    }
+    else
+    {
+      this->fields.emplace_back(std::move(name), (size_t)value);
+    }
+    return *this;
+  }
+
+  void write_json(std::ostream &output) const
+  {
+    output << "{";
+    for (size_t i = 0; i < this->fields.size(); i++)
+    {
+      const auto &[name, value] = this->fields[i];
+      output << (i ? ", \"" : "\"") << name << "\": ";
+
+      // names and texts are known not to need escaping.
+      if (const auto *text = std::get_if<std::string>(&value))
+      {
+        output << '"' << *text << '"';
+      }
+      else
+      {
+        std::visit([&](const auto &number) { output << number; }, value);
+      }
+    }
+    output << "}";
+  }
+};
+
+template <typename F> double nanoseconds_per_operation(size_t operations, F &&f)
+{
+  const auto start = Clock::now();
+  f();
+  const auto elapsed = Clock::now() - start;
+  return (double)std::chrono::nanoseconds(elapsed).count() /
+         (double)std::max<size_t>(operations, 1);
+}
+
+inline size_t physical_memory()
+{
+  return (size_t)sysconf(_SC_PHYS_PAGES) * (size_t)sysconf(_SC_PAGESIZE);
+}
+
+/**
+ * The number in the environment variable `variable`, at most `max`, or
+ * `fallback` if it's unset.
+ */
+inline size_t limit_from_environment(const char *variable, size_t fallback,
+                                     size_t max)
+{
+  const char *value = std::getenv(variable);
+  return value ? std::min<size_t>(std::stoull(value), max) : fallback;
+}
+
+/**
+ * Writes `results` as JSON to the file named by the environment variable
+ * `output_variable`, or to the standard output if it's unset.
+ */
+inline void write_json(const std::vector<Result> &results,
+                       const char *output_variable)
+{
+  std::ofstream file;
+  if (const char *path = std::getenv(output_variable)) file.open(path);
+  std::ostream &output = file.is_open() ? file : std::cout;
+
+  output << "{\n  \"results\": [";
+  for (size_t i = 0; i < results.size(); i++)
+  {
+    output << (i ? ",\n" : "\n") << "    ";
+    results[i].write_json(output);
+  }
+  output << "\n  ]\n}\n";
+}
+
+} // namespace suite
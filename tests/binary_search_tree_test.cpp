@@ -0,0 +1,241 @@
+#include "catch2/catch_all.hpp"
+#include "trees.hpp"
+#include "utils.hpp"
+#include <cmath>
+#include <iterator>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+/// Draws the keys of random operations.
+const auto random_keys = core::utils::Generator(0);
+/// Draws which random operation to run.
+const auto random_operations = core::utils::Generator(1);
+
+/// The tallest an AVL tree of `count` nodes can be.
+size_t max_avl_height(size_t count)
+{
+  return (size_t)(1.45 * std::log2((double)count + 2));
+}
+
+} // namespace
+
+TEST_CASE("it should be able to correctly insert and get elements",
+          "[BinarySearchTree, external]")
+{
+  std::vector<std::pair<int, int>> pairs = {
+      std::pair(0, 1),  std::pair(3, 2), std::pair(11, 3),
+      std::pair(12, 4), std::pair(6, 5), std::pair(14, 6)};
+
+  auto tree = core::trees::BinarySearchTree<int, int>();
+
+  for (const auto &pair : pairs) tree.insert(pair.first, pair.second);
+  tree.insert(14, 3);
+
+  for (const auto &pair : pairs)
+  {
+    const int *element = tree.get(pair.first);
+    REQUIRE(element != nullptr);
+    REQUIRE(*element == (pair.first == 14 ? 3 : pair.second));
+  }
+
+  REQUIRE(tree.get(100) == nullptr);
+  REQUIRE(tree.count() == pairs.size());
+}
+
+TEST_CASE("it should stay balanced when keys are inserted in order",
+          "[BinarySearchTree, internal]")
+{
+  auto tree = core::trees::BinarySearchTree<int, int>();
+  const int count = 100000;
+
+  for (int key = 0; key < count; key++) tree.insert(key, -key);
+
+  REQUIRE(tree.count() == count);
+  REQUIRE(tree.height() <= max_avl_height(count));
+  for (int key = 0; key < count; key++) REQUIRE(*tree.get(key) == -key);
+
+  for (int key = count - 1; key >= 0; key -= 2) tree.remove(key);
+
+  REQUIRE(tree.count() == count / 2);
+  REQUIRE(tree.height() <= max_avl_height(count / 2));
+  for (int key = 0; key < count; key++)
+  {
+    REQUIRE((tree.get(key) != nullptr) == (key % 2 == 0));
+  }
+}
+
+TEST_CASE("it should match std::map under random insertions and removals",
+          "[BinarySearchTree, internal]")
+{
+  auto tree = core::trees::BinarySearchTree<uint64_t, uint64_t>();
+  auto map = std::map<uint64_t, uint64_t>();
+
+  for (uint64_t i = 0; i < 50000; i++)
+  {
+    const auto key = random_keys.at(i, 5000);
+    if (random_operations.at(i, 3) == 0)
+    {
+      tree.remove(key);
+      map.erase(key);
+    }
+    else
+    {
+      tree.insert(key, i);
+      map.insert_or_assign(key, i);
+    }
+  }
+
+  REQUIRE(tree.count() == map.size());
+  REQUIRE(tree.height() <= max_avl_height(map.size()));
+  for (uint64_t key = 0; key < 5000; key++)
+  {
+    const auto iterator = map.find(key);
+    const uint64_t *value = tree.get(key);
+    REQUIRE((value != nullptr) == (iterator != map.end()));
+    if (value) REQUIRE(*value == iterator->second);
+  }
+}
+
+TEST_CASE("it should update values in place through find",
+          "[BinarySearchTree, external]")
+{
+  auto tree = core::trees::BinarySearchTree<std::string, int>();
+  tree.insert("one", 1);
+  tree.insert("two", 2);
+
+  *tree.find("one") += 10;
+  tree.remove("two");
+  tree.remove("three");
+
+  REQUIRE(*tree.get("one") == 11);
+  REQUIRE(tree.find("two") == nullptr);
+  REQUIRE(tree.count() == 1);
+  REQUIRE(tree.height() == 1);
+}
+
+TEST_CASE("it should be empty once every key is removed",
+          "[BinarySearchTree, external]")
+{
+  auto tree = core::trees::BinarySearchTree<int, int>();
+  REQUIRE(tree.count() == 0);
+  REQUIRE(tree.height() == 0);
+
+  for (int key = 0; key < 100; key++) tree.insert(key, key);
+  for (int key = 0; key < 100; key++) tree.remove(key);
+
+  REQUIRE(tree.count() == 0);
+  REQUIRE(tree.height() == 0);
+  REQUIRE(tree.get(0) == nullptr);
+}
+
+TEST_CASE("it should keep its links when moved and cleared",
+          "[BinarySearchTree, external]")
+{
+  auto tree = core::trees::BinarySearchTree<int, std::string>();
+  for (int key = 0; key < 10000; key++) tree.insert(key, std::to_string(key));
+
+  auto moved = std::move(tree);
+  REQUIRE(tree.count() == 0);
+  REQUIRE(tree.get(0) == nullptr);
+  REQUIRE(moved.count() == 10000);
+  for (int key = 0; key < 10000; key++)
+  {
+    REQUIRE(*moved.get(key) == std::to_string(key));
+  }
+
+  moved.clear();
+  REQUIRE(moved.count() == 0);
+  REQUIRE(moved.height() == 0);
+  REQUIRE(moved.memory_usage() == 0);
+
+  moved.insert(1, "one");
+  REQUIRE(*moved.get(1) == "one");
+}
+
+TEST_CASE("it should rank and select keys by position",
+          "[BinarySearchTree, external]")
+{
+  auto tree = core::trees::BinarySearchTree<int, int>();
+  for (int key = 0; key < 1000; key++) tree.insert(key * 10, key);
+
+  REQUIRE(tree.rank(0) == 0);
+  REQUIRE(tree.rank(5) == 1);
+  REQUIRE(tree.rank(500) == 50);
+  REQUIRE(tree.rank(100000) == 1000);
+
+  REQUIRE(*tree.select(0) == 0);
+  REQUIRE(*tree.select(123) == 1230);
+  REQUIRE(*tree.select(999) == 9990);
+  REQUIRE(tree.select(1000) == nullptr);
+
+  REQUIRE(tree.count_in_range(100, 200) == 10);
+  REQUIRE(tree.count_in_range(95, 201) == 11);
+  REQUIRE(tree.count_in_range(200, 100) == 0);
+  REQUIRE(tree.count_in_range(-50, 50000) == 1000);
+}
+
+TEST_CASE("it should keep subtree sizes through rotations and removals",
+          "[BinarySearchTree, internal]")
+{
+  auto tree = core::trees::BinarySearchTree<uint64_t, uint64_t>();
+  auto map = std::map<uint64_t, uint64_t>();
+
+  for (uint64_t i = 0; i < 20000; i++)
+  {
+    const auto key = random_keys.at(i, 3000);
+    if (random_operations.at(i, 3) == 0)
+    {
+      tree.remove(key);
+      map.erase(key);
+    }
+    else
+    {
+      tree.insert(key, i);
+      map.insert_or_assign(key, i);
+    }
+  }
+
+  size_t position = 0;
+  for (const auto &[key, value] : map)
+  {
+    REQUIRE(tree.rank(key) == position);
+    REQUIRE(*tree.select(position) == key);
+    position++;
+  }
+  REQUIRE(tree.select(position) == nullptr);
+  REQUIRE(tree.count_in_range(1000, 2000) ==
+          (size_t)std::distance(map.lower_bound(1000), map.lower_bound(2000)));
+}
+
+TEST_CASE("it should visit keys and ranges in order",
+          "[BinarySearchTree, external]")
+{
+  auto tree = core::trees::BinarySearchTree<int, int>();
+  auto map = std::map<int, int>();
+  for (uint64_t i = 0; i < 2000; i++)
+  {
+    const auto key = (int)random_keys.at(i, 5000);
+    tree.insert(key, (int)i);
+    map.insert_or_assign(key, (int)i);
+  }
+
+  using Pairs = std::vector<std::pair<int, int>>;
+  Pairs pairs;
+  tree.for_each([&](const int &key, const int &value)
+                { pairs.emplace_back(key, value); });
+  REQUIRE(pairs == Pairs(map.begin(), map.end()));
+
+  for (const auto &[low, high] : {std::pair(-10, 10), std::pair(1000, 1200),
+                                  std::pair(4990, 6000), std::pair(7, 7)})
+  {
+    pairs.clear();
+    tree.for_each_in_range(low, high, [&](const int &key, const int &value)
+                           { pairs.emplace_back(key, value); });
+    REQUIRE(pairs == Pairs(map.lower_bound(low), map.lower_bound(high)));
+  }
+}
@@ -0,0 +1,161 @@
+#include "catch2/catch_all.hpp"
+#include "hash_table.hpp"
+#include <string>
+#include <vector>
+
+TEST_CASE("it should never report an inserted key as absent",
+          "[BloomFilter, external]")
+{
+  auto filter = core::hash_table::BloomFilter<size_t>(1000);
+  for (size_t key = 0; key < 1000; key++) filter.insert(key * 7);
+  for (size_t key = 0; key < 1000; key++) REQUIRE(filter.contains(key * 7));
+
+  auto strings = core::hash_table::BloomFilter<std::string>(10);
+  strings.insert("apple");
+  REQUIRE(strings.contains("apple"));
+}
+
+TEST_CASE("it should keep close to the requested false positive rate",
+          "[BloomFilter, external]")
+{
+  const size_t keys_count = 100000;
+
+  for (const double rate : {0.1, 0.01, 0.001})
+  {
+    auto filter = core::hash_table::BloomFilter<size_t>(keys_count, rate);
+    for (size_t key = 0; key < keys_count; key++) filter.insert(key);
+
+    size_t false_positives = 0;
+    for (size_t key = keys_count; key < keys_count * 2; key++)
+    {
+      false_positives += filter.contains(key);
+    }
+
+    REQUIRE((double)false_positives / keys_count < rate * 1.5);
+  }
+}
+
+TEST_CASE("it should reject invalid false positive rates",
+          "[BloomFilter, external]")
+{
+  using Filter = core::hash_table::BloomFilter<size_t>;
+  REQUIRE_THROWS_AS(Filter(10, 0), std::invalid_argument);
+  REQUIRE_THROWS_AS(Filter(10, 1), std::invalid_argument);
+}
+
+TEST_CASE("it should forget removed keys", "[CountingBloomFilter, external]")
+{
+  auto filter = core::hash_table::CountingBloomFilter<size_t>(1000);
+  for (size_t key = 0; key < 1000; key++) filter.insert(key);
+  for (size_t key = 0; key < 1000; key += 2) filter.remove(key);
+
+  size_t false_positives = 0;
+  for (size_t key = 0; key < 1000; key++)
+  {
+    if (key % 2) REQUIRE(filter.contains(key));
+    else false_positives += filter.contains(key);
+  }
+  REQUIRE(false_positives < 25);
+
+  filter.clear();
+  REQUIRE_FALSE(filter.contains(1));
+}
+
+TEST_CASE("it should keep saturated counters set",
+          "[CountingBloomFilter, internal]")
+{
+  auto filter = core::hash_table::CountingBloomFilter<size_t>(1);
+
+  // more insertions than a counter can count.
+  for (size_t i = 0; i < 20; i++) filter.insert(42);
+  for (size_t i = 0; i < 19; i++) filter.remove(42);
+  REQUIRE(filter.contains(42));
+}
+
+TEST_CASE("it should filter lookups of either table",
+          "[FilteredHashTable, external]")
+{
+  using namespace core::hash_table;
+
+  auto oa = FilteredHashTable<int>(4);
+  auto sc = FilteredHashTable<int, size_t, Hash<size_t>, SCHashTable<int>>(4);
+
+  // outgrows the filters' initial size, so that they're rebuilt.
+  for (size_t key = 0; key < 500; key++)
+  {
+    oa.insert(key, key * 2);
+    sc.insert(key, key * 2);
+  }
+  oa.insert(3, 1);
+  sc.insert(3, 1);
+
+  for (size_t key = 0; key < 500; key += 2)
+  {
+    oa.remove(key);
+    sc.remove(key);
+  }
+  oa.remove(1000);
+
+  REQUIRE(oa.size() == 250);
+  REQUIRE(sc.size() == 250);
+
+  for (size_t key = 0; key < 1000; key++)
+  {
+    const auto expected =
+        key < 500 && key % 2 ? std::optional<int>(key == 3 ? 1 : key * 2)
+                             : std::nullopt;
+    REQUIRE(oa.get(key) == expected);
+    REQUIRE(sc.get(key) == expected);
+    REQUIRE((oa.find(key) != nullptr) == expected.has_value());
+  }
+}
+
+TEST_CASE("it should keep working with a non-counting filter",
+          "[FilteredHashTable, external]")
+{
+  using namespace core::hash_table;
+
+  auto hash_table = FilteredHashTable<int, size_t, Hash<size_t>,
+                                      OAHashTable<int>, BloomFilter<size_t>>(8);
+  hash_table.insert(1, 10);
+  hash_table.insert(2, 20);
+  hash_table.remove(1);
+
+  REQUIRE_FALSE(hash_table.get(1).has_value());
+  REQUIRE(hash_table.get(2) == 20);
+  REQUIRE(hash_table.filter().contains(1));
+}
+
+TEST_CASE("Filtered lookups of absent keys", "[benchmark][FilteredHashTable]")
+{
+  const size_t keys_count = 1 << 16;
+
+  auto oa = core::hash_table::OAHashTable<size_t>(keys_count);
+  auto filtered = core::hash_table::FilteredHashTable<size_t>(keys_count);
+  for (size_t key = 0; key < keys_count; key++)
+  {
+    oa.insert(key * 2, key);
+    filtered.insert(key * 2, key);
+  }
+
+  // 90% of the lookups miss.
+  std::vector<size_t> keys(keys_count);
+  for (size_t i = 0; i < keys_count; i++)
+  {
+    keys[i] = i % 10 ? (i * 2 + 1) : i * 2;
+  }
+
+  BENCHMARK("OAHashTable")
+  {
+    size_t found = 0;
+    for (const auto key : keys) found += oa.find(key) != nullptr;
+    return found;
+  };
+
+  BENCHMARK("FilteredHashTable")
+  {
+    size_t found = 0;
+    for (const auto key : keys) found += filtered.find(key) != nullptr;
+    return found;
+  };
+}
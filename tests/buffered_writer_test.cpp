@@ -0,0 +1,113 @@
+#include "catch2/catch_all.hpp"
+#include "utils.hpp"
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+TEST_CASE("it should write numbers as JSON arrays",
+          "[BufferedWriter, external]")
+{
+  auto output = std::ostringstream();
+  {
+    auto writer = core::utils::BufferedWriter(output);
+    const std::vector<int64_t> integers = {0, -12, 9000000000};
+    const std::vector<double> doubles = {
+        1.5, -0.1, 1e300, std::numeric_limits<double>::infinity()};
+    const std::vector<int> empty;
+
+    writer.write_json<int64_t>(integers).write('\n');
+    writer.write_json<double>(doubles).write('\n');
+    writer.write_json<int>(empty);
+  }
+
+  REQUIRE(output.str() == "[0, -12, 9000000000]\n"
+                          "[1.5, -0.1, 1e+300, null]\n"
+                          "[]");
+}
+
+TEST_CASE("it should quote and escape strings", "[BufferedWriter, external]")
+{
+  const std::vector<std::string> strings = {"plain", "say \"hi\"", "a,b",
+                                            "line\nbreak", "tab\t\x01"};
+
+  auto json = std::ostringstream();
+  auto csv = std::ostringstream();
+  {
+    auto json_writer = core::utils::BufferedWriter(json);
+    json_writer.write_json<std::string>(strings);
+
+    auto csv_writer = core::utils::BufferedWriter(csv);
+    csv_writer.write_csv<std::string>(strings);
+  }
+
+  REQUIRE(json.str() == "[\"plain\", \"say \\\"hi\\\"\", \"a,b\", "
+                        "\"line\\nbreak\", \"tab\\t\\u0001\"]");
+  REQUIRE(csv.str() == "plain\n\"say \"\"hi\"\"\"\n\"a,b\"\n"
+                       "\"line\nbreak\"\ntab\t\x01\n");
+}
+
+TEST_CASE("it should flush whenever its buffer fills up",
+          "[BufferedWriter, internal]")
+{
+  std::vector<uint32_t> numbers(10000);
+  std::string expected;
+  for (uint32_t i = 0; i < numbers.size(); i++)
+  {
+    numbers[i] = i * 7919;
+    expected += std::to_string(numbers[i]) + "\n";
+  }
+  const auto long_text = std::string(500, 'x');
+  expected += long_text;
+
+  auto output = std::ostringstream();
+  {
+    // smaller than the longest text, and than a few numbers.
+    auto writer = core::utils::BufferedWriter(output, 100);
+    writer.write_csv<uint32_t>(numbers);
+    writer.write(long_text);
+    writer.flush();
+    REQUIRE(output.str() == expected);
+  }
+  REQUIRE(output.str() == expected);
+}
+
+TEST_CASE("print_vector still writes through std::cout",
+          "[BufferedWriter, external]")
+{
+  const double array[] = {0.25, 2, -3.5};
+  auto printed = std::stringstream();
+
+  auto cout_buffer = std::cout.rdbuf(printed.rdbuf());
+  core::utils::print_vector<double>(array);
+  std::cout.rdbuf(cout_buffer);
+
+  REQUIRE(printed.str() == "[0.25, 2, -3.5]\n");
+}
+
+TEST_CASE("Printing 1M ints", "[benchmark][BufferedWriter]")
+{
+  const auto numbers = core::utils::generate_random_ints_vector(
+      1'000'000, 1, std::numeric_limits<int>::max());
+  auto null = std::ofstream("/dev/null");
+
+  BENCHMARK("std::to_string through std::ostream")
+  {
+    null << "[";
+    for (size_t i = 0; i < numbers.size(); i++)
+    {
+      null << std::to_string(numbers[i]);
+      if (i + 1 < numbers.size()) null << ", ";
+    }
+    null << "]";
+  };
+
+  BENCHMARK("BufferedWriter")
+  {
+    auto writer = core::utils::BufferedWriter(null);
+    writer.write_json<int>(numbers);
+  };
+}
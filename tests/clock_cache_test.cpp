@@ -0,0 +1,115 @@
+#include "cache.hpp"
+#include "catch2/catch_all.hpp"
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+TEST_CASE("it should give referenced entries a second chance",
+          "[ClockCache, external]")
+{
+  auto cache = core::cache::ClockCache<int>(3);
+
+  cache.put(1, 10);
+  cache.put(2, 20);
+  cache.put(3, 30);
+  REQUIRE(*cache.get(1) == 10);
+  REQUIRE(*cache.get(3) == 30);
+
+  cache.put(4, 40);
+
+  REQUIRE(cache.size() == 3);
+  REQUIRE_FALSE(cache.contains(2));
+  REQUIRE(*cache.get(1) == 10);
+  REQUIRE(*cache.get(3) == 30);
+  REQUIRE(*cache.get(4) == 40);
+}
+
+TEST_CASE("it should evict in insertion order when nothing is referenced",
+          "[ClockCache, internal]")
+{
+  auto cache = core::cache::ClockCache<int>(3);
+  for (size_t key = 0; key < 3; key++) cache.put(key, (int)key);
+
+  REQUIRE(cache.evict() == std::pair<size_t, int>(0, 0));
+  REQUIRE(cache.evict() == std::pair<size_t, int>(1, 1));
+  REQUIRE(cache.evict() == std::pair<size_t, int>(2, 2));
+  REQUIRE_FALSE(cache.evict().has_value());
+}
+
+TEST_CASE("it should count hits, misses and evictions",
+          "[ClockCache, external]")
+{
+  auto cache = core::cache::ClockCache<int>(2);
+
+  cache.put(1, 10);
+  cache.put(2, 20);
+  cache.put(3, 30);
+  cache.get(1);
+  cache.get(2);
+  cache.get(3);
+
+  const auto stats = cache.stats();
+  REQUIRE(stats.hits == 2);
+  REQUIRE(stats.misses == 1);
+  REQUIRE(stats.evictions == 1);
+}
+
+TEST_CASE("it should fill removed slots before evicting",
+          "[ClockCache, external]")
+{
+  auto cache = core::cache::ClockCache<int>(3);
+  for (size_t key = 0; key < 3; key++) cache.put(key, (int)key);
+
+  REQUIRE(cache.remove(1));
+  REQUIRE_FALSE(cache.remove(1));
+  cache.put(5, 5);
+
+  REQUIRE(cache.stats().evictions == 0);
+  REQUIRE(cache.size() == 3);
+  REQUIRE(*cache.get(5) == 5);
+}
+
+TEST_CASE("it should keep frequently used keys under churn",
+          "[ClockCache, internal]")
+{
+  const size_t capacity = 1000;
+  auto cache = core::cache::ClockCache<size_t>(capacity);
+
+  for (size_t key = 0; key < capacity / 4; key++) cache.put(key, key);
+
+  // a quarter of the keys is used over and over, among a scan of new ones.
+  for (size_t key = capacity; key < capacity * 20; key++)
+  {
+    cache.put(key, key);
+    REQUIRE(cache.find(key % (capacity / 4)) != nullptr);
+    REQUIRE(cache.size() <= capacity);
+  }
+
+  REQUIRE(cache.size() == capacity);
+  REQUIRE(cache.stats().misses == 0);
+}
+
+TEST_CASE("it should size itself to a memory budget",
+          "[ClockCache, external]")
+{
+  auto cache = core::cache::ClockCache<size_t>::with_memory_budget(1 << 20);
+
+  REQUIRE(cache.capacity() > 0);
+  REQUIRE(cache.capacity() < (1 << 20) / (sizeof(size_t) * 2));
+  REQUIRE_THROWS_AS(core::cache::ClockCache<size_t>(0),
+                    std::invalid_argument);
+}
+
+TEST_CASE("it should look string keys up by string views",
+          "[ClockCache, external]")
+{
+  auto cache = core::cache::ClockCache<int, std::string>(2);
+
+  cache.put("one", 1);
+  cache.put("two", 2);
+
+  REQUIRE(*cache.find(std::string_view("one")) == 1);
+  cache.put("three", 3);
+  REQUIRE(cache.find(std::string_view("two")) == nullptr);
+}
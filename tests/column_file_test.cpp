@@ -0,0 +1,110 @@
+#include "catch2/catch_all.hpp"
+#include "utils.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+std::string column_path(const std::string &name)
+{
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+} // namespace
+
+TEMPLATE_TEST_CASE("it should read back every written element",
+                   "[ColumnFile, external]", int32_t, int64_t, uint32_t,
+                   uint64_t, float, double)
+{
+  const auto path = column_path("column_file_test.col");
+  const auto numbers = core::utils::Generator(5).uniform(100003);
+  const auto values = std::vector<TestType>(numbers.begin(), numbers.end());
+
+  core::utils::write_column_file(path, std::span<const TestType>(values));
+
+  const auto file = core::utils::ColumnFile(path);
+  REQUIRE(file.type() == core::utils::column_type_of<TestType>());
+  REQUIRE(file.size() == values.size());
+
+  const auto mapped = file.values<TestType>();
+  REQUIRE(std::ranges::equal(mapped, values));
+  // the elements are served from the mapping, aligned to a cache line.
+  REQUIRE((uintptr_t)mapped.data() % 64 == 0);
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("it should write and map empty columns", "[ColumnFile, external]")
+{
+  const auto path = column_path("column_file_empty_test.col");
+  core::utils::write_column_file(path, std::span<const double>());
+
+  const auto file = core::utils::ColumnFile(path);
+  REQUIRE(file.type() == core::utils::ColumnType::Float64);
+  REQUIRE(file.values<double>().empty());
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("it should name and parse every column type",
+          "[ColumnFile, internal]")
+{
+  using core::utils::ColumnType;
+
+  for (const auto type : {ColumnType::Int32, ColumnType::Int64,
+                          ColumnType::UInt32, ColumnType::UInt64,
+                          ColumnType::Float32, ColumnType::Float64})
+  {
+    REQUIRE(core::utils::parse_column_type(core::utils::name_of(type)) ==
+            type);
+  }
+
+  REQUIRE(core::utils::size_of(ColumnType::UInt32) == 4);
+  REQUIRE(core::utils::size_of(ColumnType::Float64) == 8);
+  REQUIRE_THROWS_AS(core::utils::parse_column_type("int128"),
+                    std::invalid_argument);
+}
+
+TEST_CASE("it should refuse columns of other types or corrupted ones",
+          "[ColumnFile, internal]")
+{
+  const auto path = column_path("column_file_corrupted_test.col");
+  const auto values = std::vector<int64_t>{3, 1, 2};
+  core::utils::write_column_file(path, std::span<const int64_t>(values));
+
+  SECTION("different element type")
+  {
+    const auto file = core::utils::ColumnFile(path);
+    REQUIRE_THROWS_AS(file.values<uint64_t>(), std::runtime_error);
+    REQUIRE_THROWS_AS(file.values<double>(), std::runtime_error);
+  }
+
+  SECTION("truncated payload")
+  {
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+    REQUIRE_THROWS_AS(core::utils::ColumnFile(path), std::runtime_error);
+  }
+
+  SECTION("not a column file")
+  {
+    {
+      auto file = std::ofstream(path, std::ios::binary | std::ios::trunc);
+      file << "definitely not a column of numbers, but long enough";
+    }
+
+    REQUIRE_THROWS_AS(core::utils::ColumnFile(path), std::runtime_error);
+  }
+
+  SECTION("missing file")
+  {
+    REQUIRE_THROWS_AS(core::utils::ColumnFile(path + ".missing"),
+                      std::runtime_error);
+  }
+
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,280 @@
+#include "catch2/catch_all.hpp"
+#include "hash_table.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+TEST_CASE("it should be able to correctly insert and get elements",
+          "[ConcurrentHashTable, external]")
+{
+  std::vector<std::pair<size_t, int>> pairs = {
+      std::pair(0, 1),  std::pair(3, 2), std::pair(11, 3),
+      std::pair(12, 4), std::pair(6, 5), std::pair(14, 6)};
+
+  auto hash_table = core::hash_table::ConcurrentHashTable<int>(10, 2);
+
+  for (const auto &pair : pairs)
+  {
+    REQUIRE_NOTHROW(hash_table.insert(pair.first, pair.second));
+  }
+  REQUIRE_NOTHROW(hash_table.insert(14, 3));
+
+  for (const auto &pair : pairs)
+  {
+    auto element = hash_table.get(pair.first);
+    REQUIRE(element.has_value());
+    REQUIRE(*element == (pair.first == 14 ? 3 : pair.second));
+  }
+
+  REQUIRE(hash_table.size() == pairs.size());
+}
+
+TEST_CASE("it should remove a value by key and keep finding its neighbours",
+          "[ConcurrentHashTable, external]")
+{
+  auto hash_table = core::hash_table::ConcurrentHashTable<int>(4, 1);
+
+  for (size_t key = 0; key < 100; key++) hash_table.insert(key, key * 2);
+  REQUIRE(hash_table.size() == 100);
+  REQUIRE(hash_table.capacity() >= 200);
+
+  for (size_t key = 0; key < 100; key += 2) hash_table.remove(key);
+  REQUIRE(hash_table.size() == 50);
+
+  for (size_t key = 0; key < 100; key++)
+  {
+    auto element = hash_table.get(key);
+    REQUIRE(element.has_value() == (key % 2 == 1));
+    if (element) REQUIRE(*element == (int)key * 2);
+  }
+}
+
+TEST_CASE("it should not lose writes from concurrent writers",
+          "[ConcurrentHashTable, external]")
+{
+  const size_t threads_count = 4;
+  const size_t keys_per_thread = 5000;
+  auto hash_table = core::hash_table::ConcurrentHashTable<size_t>(16, 4);
+
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < threads_count; t++)
+  {
+    threads.emplace_back(
+        [&hash_table, t]
+        {
+          for (size_t i = 0; i < keys_per_thread; i++)
+          {
+            const auto key = i * threads_count + t;
+            hash_table.insert(key, key + 1);
+          }
+        });
+  }
+  for (auto &thread : threads) thread.join();
+
+  REQUIRE(hash_table.size() == threads_count * keys_per_thread);
+  for (size_t key = 0; key < threads_count * keys_per_thread; key++)
+  {
+    auto element = hash_table.get(key);
+    REQUIRE(element.has_value());
+    REQUIRE(*element == key + 1);
+  }
+}
+
+TEST_CASE("readers should never observe torn or misplaced values",
+          "[ConcurrentHashTable, internal]")
+{
+  const size_t keys_count = 2000;
+  auto hash_table = core::hash_table::ConcurrentHashTable<size_t>(8, 2);
+  std::atomic<bool> done = false;
+  std::atomic<size_t> inconsistencies = 0;
+
+  auto writer = std::thread(
+      [&]
+      {
+        for (size_t round = 0; round < 20; round++)
+        {
+          for (size_t key = 0; key < keys_count; key++)
+          {
+            hash_table.insert(key, key * 3);
+          }
+          for (size_t key = round % 2; key < keys_count; key += 2)
+          {
+            hash_table.remove(key);
+          }
+        }
+        done = true;
+      });
+
+  auto reader = std::thread(
+      [&]
+      {
+        while (!done)
+        {
+          for (size_t key = 0; key < keys_count; key++)
+          {
+            auto element = hash_table.get(key);
+            if (element && *element != key * 3) inconsistencies++;
+          }
+        }
+      });
+
+  writer.join();
+  reader.join();
+
+  REQUIRE(inconsistencies == 0);
+}
+
+TEST_CASE("readers should never observe torn values wider than a word",
+          "[ConcurrentHashTable, internal]")
+{
+  // two words aren't always stored atomically, so they're copied bytewise.
+  struct Pair
+  {
+    uint64_t first;
+    uint64_t second;
+  };
+
+  const size_t keys_count = 500;
+  auto hash_table = core::hash_table::ConcurrentHashTable<Pair>(8, 2);
+  std::atomic<bool> done = false;
+  std::atomic<size_t> inconsistencies = 0;
+
+  auto writer = std::thread(
+      [&]
+      {
+        for (uint64_t round = 0; round < 50; round++)
+        {
+          for (size_t key = 0; key < keys_count; key++)
+          {
+            hash_table.insert(key, Pair{round, round});
+          }
+        }
+        done = true;
+      });
+
+  auto reader = std::thread(
+      [&]
+      {
+        while (!done)
+        {
+          for (size_t key = 0; key < keys_count; key++)
+          {
+            auto element = hash_table.get(key);
+            if (element && element->first != element->second)
+            {
+              inconsistencies++;
+            }
+          }
+        }
+      });
+
+  writer.join();
+  reader.join();
+
+  REQUIRE(inconsistencies == 0);
+  REQUIRE(hash_table.get(0)->first == 49);
+}
+
+TEST_CASE("it should hash keys with the given hasher",
+          "[ConcurrentHashTable, external]")
+{
+  // sends every key to the same shard and home slot.
+  struct ConstantHash
+  {
+    size_t operator()(size_t) const { return 0; }
+  };
+
+  using core::hash_table::ConcurrentHashTable;
+  auto hash_table = ConcurrentHashTable<size_t, size_t, ConstantHash>(64, 4);
+  for (size_t key = 0; key < 20; key++) hash_table.insert(key, key * 2);
+  hash_table.remove(5);
+
+  for (size_t key = 0; key < 20; key++)
+  {
+    if (key == 5) REQUIRE_FALSE(hash_table.get(key).has_value());
+    else REQUIRE(hash_table.get(key) == key * 2);
+  }
+}
+
+TEST_CASE("Concurrent hash table throughput",
+          "[benchmark][ConcurrentHashTable]")
+{
+  const size_t keys_count = 1 << 16;
+  const size_t operations_per_thread = 1 << 16;
+  const size_t max_threads =
+      std::max(1u, std::thread::hardware_concurrency());
+
+  // Runs `operations_per_thread` operations on every thread, in which
+  // `read_percentage`% are `get`s and the rest are `insert`s.
+  const auto run = [&](size_t threads_count, size_t read_percentage,
+                       auto &&get, auto &&insert)
+  {
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threads_count; t++)
+    {
+      threads.emplace_back(
+          [&, t]
+          {
+            size_t state = t + 1;
+            for (size_t i = 0; i < operations_per_thread; i++)
+            {
+              state = state * 6364136223846793005ull + 1442695040888963407ull;
+              const auto key = (state >> 33) % keys_count;
+              if ((state >> 20) % 100 < read_percentage) get(key);
+              else insert(key, i);
+            }
+          });
+    }
+    for (auto &thread : threads) thread.join();
+  };
+
+  for (const size_t read_percentage : {50, 90, 99})
+  {
+    for (size_t threads_count = 1; threads_count <= max_threads;
+         threads_count *= 2)
+    {
+      const auto label = std::to_string(threads_count) + " threads, " +
+                         std::to_string(read_percentage) + "% reads";
+
+      auto concurrent =
+          core::hash_table::ConcurrentHashTable<size_t>(keys_count);
+      auto locked = core::hash_table::OAHashTable<size_t>(keys_count);
+      auto mutex = std::mutex();
+
+      for (size_t key = 0; key < keys_count; key++)
+      {
+        concurrent.insert(key, key);
+        locked.insert(key, key);
+      }
+
+      BENCHMARK("ConcurrentHashTable, " + label)
+      {
+        run(
+            threads_count, read_percentage,
+            [&](size_t key) { return concurrent.get(key); },
+            [&](size_t key, size_t value) { concurrent.insert(key, value); });
+      };
+
+      BENCHMARK("mutex-wrapped OAHashTable, " + label)
+      {
+        run(
+            threads_count, read_percentage,
+            [&](size_t key)
+            {
+              const std::lock_guard lock(mutex);
+              return locked.get(key);
+            },
+            [&](size_t key, size_t value)
+            {
+              const std::lock_guard lock(mutex);
+              locked.insert(key, value);
+            });
+      };
+    }
+  }
+}
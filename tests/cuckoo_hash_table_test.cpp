@@ -0,0 +1,95 @@
+#include "catch2/catch_all.hpp"
+#include "hash_table.hpp"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+TEST_CASE("it should be able to correctly insert and get elements",
+          "[CuckooHashTable, external]")
+{
+  std::vector<std::pair<size_t, int>> pairs = {
+      std::pair(0, 1),  std::pair(3, 2), std::pair(11, 3),
+      std::pair(12, 4), std::pair(6, 5), std::pair(14, 6)};
+
+  auto hash_table = core::hash_table::CuckooHashTable<int>(8);
+
+  for (const auto &pair : pairs)
+  {
+    REQUIRE_NOTHROW(hash_table.insert(pair.first, pair.second));
+  }
+  REQUIRE_NOTHROW(hash_table.insert(14, 3));
+
+  for (const auto &pair : pairs)
+  {
+    auto element = hash_table.get(pair.first);
+    REQUIRE(element.has_value());
+    REQUIRE(*element == (pair.first == 14 ? 3 : pair.second));
+  }
+
+  REQUIRE_FALSE(hash_table.get(100).has_value());
+  REQUIRE(hash_table.size() == pairs.size());
+}
+
+TEST_CASE("it should remove a value by key", "[CuckooHashTable, external]")
+{
+  auto hash_table = core::hash_table::CuckooHashTable<std::string>(8);
+
+  for (size_t key = 0; key < 100; key++)
+  {
+    hash_table.insert(key, std::to_string(key));
+  }
+  for (size_t key = 0; key < 100; key += 2) hash_table.remove(key);
+  hash_table.remove(1000);
+
+  for (size_t key = 0; key < 100; key++)
+  {
+    auto element = hash_table.get(key);
+    REQUIRE(element.has_value() == (key % 2 == 1));
+    if (element) REQUIRE(*element == std::to_string(key));
+  }
+
+  REQUIRE(hash_table.size() == 50);
+}
+
+TEST_CASE("it should displace keys rather than growing while there's room",
+          "[CuckooHashTable, internal]")
+{
+  // 8-byte keys and values get three slots per bucket, so the capacity is
+  // rounded up to three slots times a power of two.
+  auto hash_table = core::hash_table::CuckooHashTable<size_t>(1 << 12);
+  const auto capacity = hash_table.capacity();
+  REQUIRE(capacity >= 1 << 12);
+
+  // a 3-way bucketized cuckoo table should be filled well above 90% before
+  // it needs to grow.
+  size_t key = 0;
+  while (hash_table.capacity() == capacity)
+  {
+    hash_table.insert(key * 31, key);
+    key++;
+  }
+
+  REQUIRE(key > capacity * 0.9);
+
+  for (size_t i = 0; i < key; i++)
+  {
+    REQUIRE(hash_table.find(i * 31) != nullptr);
+    REQUIRE(*hash_table.find(i * 31) == i);
+  }
+  REQUIRE(hash_table.size() == key);
+}
+
+TEST_CASE("it should fit buckets of 8-byte keys and values in a cache line",
+          "[CuckooHashTable, internal]")
+{
+  using core::hash_table::CuckooHashTable;
+  // occupancy included, so that a lookup touches at most two cache lines.
+  STATIC_REQUIRE(CuckooHashTable<size_t>::bucket_size == 64);
+  STATIC_REQUIRE(CuckooHashTable<uint32_t, uint32_t>::bucket_size == 64);
+
+  auto hash_table = CuckooHashTable<size_t>(12);
+  REQUIRE(hash_table.capacity() == 12);
+  for (size_t key = 0; key < 12; key++) hash_table.insert(key, key);
+  for (size_t key = 0; key < 12; key++) REQUIRE(*hash_table.find(key) == key);
+}
@@ -0,0 +1,93 @@
+#include "catch2/catch_all.hpp"
+#include "hash_table.hpp"
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+TEST_CASE("it should be able to correctly insert and get elements",
+          "[DenseHashTable, external]")
+{
+  std::vector<std::pair<size_t, int>> pairs = {
+      std::pair(0, 1),  std::pair(3, 2), std::pair(11, 3),
+      std::pair(12, 4), std::pair(6, 5), std::pair(14, 6)};
+
+  auto hash_table = core::hash_table::DenseHashTable<int>(2);
+
+  for (const auto &pair : pairs)
+  {
+    REQUIRE_NOTHROW(hash_table.insert(pair.first, pair.second));
+  }
+  REQUIRE_NOTHROW(hash_table.insert(14, 3));
+
+  for (const auto &pair : pairs)
+  {
+    auto element = hash_table.get(pair.first);
+    REQUIRE(element.has_value());
+    REQUIRE(*element == (pair.first == 14 ? 3 : pair.second));
+  }
+
+  REQUIRE_FALSE(hash_table.get(100).has_value());
+  REQUIRE(hash_table.size() == pairs.size());
+}
+
+TEST_CASE("it should iterate over its elements in insertion order",
+          "[DenseHashTable, external]")
+{
+  auto hash_table = core::hash_table::DenseHashTable<int>(4);
+  const std::vector<std::pair<size_t, int>> pairs = {
+      std::pair(40, 1), std::pair(10, 2), std::pair(30, 3), std::pair(20, 4)};
+
+  for (const auto &pair : pairs) hash_table.insert(pair.first, pair.second);
+
+  REQUIRE(std::ranges::equal(hash_table, pairs));
+  REQUIRE(std::ranges::equal(hash_table.elements(), pairs));
+}
+
+TEST_CASE("it should fill removed entries with the last one",
+          "[DenseHashTable, internal]")
+{
+  auto hash_table = core::hash_table::DenseHashTable<int>(4);
+  for (size_t key = 0; key < 4; key++) hash_table.insert(key, key);
+
+  hash_table.remove(1);
+
+  const std::vector<std::pair<size_t, int>> expected = {
+      std::pair(0, 0), std::pair(3, 3), std::pair(2, 2)};
+  REQUIRE(std::ranges::equal(hash_table, expected));
+  REQUIRE(*hash_table.get(3) == 3);
+}
+
+TEST_CASE("it should keep every remaining key reachable after removals",
+          "[DenseHashTable, internal]")
+{
+  auto hash_table = core::hash_table::DenseHashTable<int>(2);
+
+  for (size_t key = 0; key < 1000; key++) hash_table.insert(key * 64, key);
+  for (size_t key = 0; key < 1000; key += 3) hash_table.remove(key * 64);
+  hash_table.remove(100000);
+
+  for (size_t key = 0; key < 1000; key++)
+  {
+    auto element = hash_table.get(key * 64);
+    REQUIRE(element.has_value() == (key % 3 != 0));
+    if (element) REQUIRE(*element == (int)key);
+  }
+
+  REQUIRE(hash_table.size() == 666);
+}
+
+TEST_CASE("it should look string keys up by string views",
+          "[DenseHashTable, external]")
+{
+  auto hash_table = core::hash_table::DenseHashTable<int, std::string>(2);
+  hash_table.insert("one", 1);
+  hash_table.try_emplace(std::string("two"), 2);
+  hash_table.insert_or_assign(std::string("one"), 11);
+
+  REQUIRE(*hash_table.find(std::string_view("one")) == 11);
+  REQUIRE(*hash_table.find("two") == 2);
+  REQUIRE(hash_table.find(std::string_view("three")) == nullptr);
+  REQUIRE(hash_table.size() == 2);
+}
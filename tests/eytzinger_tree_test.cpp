@@ -0,0 +1,101 @@
+#include "catch2/catch_all.hpp"
+#include "trees.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+/// Draws the keys of random operations.
+const auto random_keys = core::utils::Generator(0);
+
+} // namespace
+
+TEST_CASE("it should find the lower bound of any key",
+          "[EytzingerTree, external]")
+{
+  std::vector<int> keys;
+  for (int key = 0; key < 1000; key += 3) keys.push_back(key);
+
+  auto tree = core::trees::EytzingerTree<int>(keys);
+
+  REQUIRE(tree.size() == keys.size());
+  for (int key = -5; key < 1005; key++)
+  {
+    const auto expected = std::ranges::lower_bound(keys, key);
+    const int *found = tree.lower_bound(key);
+    REQUIRE((found != nullptr) == (expected != keys.end()));
+    if (found) REQUIRE(*found == *expected);
+    REQUIRE(tree.contains(key) == (key >= 0 && key % 3 == 0 && key < 1000));
+  }
+}
+
+TEST_CASE("it should match std::lower_bound on every size",
+          "[EytzingerTree, internal]")
+{
+  for (size_t size = 0; size < 300; size++)
+  {
+    std::vector<uint64_t> keys(size);
+    for (size_t i = 0; i < size; i++) keys[i] = random_keys.at(i, 1000);
+    std::ranges::sort(keys);
+
+    auto tree = core::trees::EytzingerTree<uint64_t>(keys);
+
+    for (uint64_t key = 0; key <= 1000; key += 7)
+    {
+      const auto expected = std::ranges::lower_bound(keys, key);
+      const uint64_t *found = tree.lower_bound(key);
+      REQUIRE((found != nullptr) == (expected != keys.end()));
+      if (found) REQUIRE(*found == *expected);
+    }
+  }
+}
+
+TEST_CASE("it should order string keys", "[EytzingerTree, external]")
+{
+  std::vector<std::string> keys = {"pear", "apple", "fig", "plum", "kiwi"};
+  std::ranges::sort(keys);
+
+  auto tree = core::trees::EytzingerTree<std::string>(keys);
+
+  REQUIRE(*tree.lower_bound("banana") == "fig");
+  REQUIRE(tree.contains("plum"));
+  REQUIRE(tree.lower_bound("zucchini") == nullptr);
+
+  const std::vector<int> unsorted = {2, 1};
+  REQUIRE_THROWS_AS(core::trees::EytzingerTree<int>(unsorted),
+                    std::invalid_argument);
+}
+
+TEST_CASE("Lower bounds over 10M keys", "[benchmark][EytzingerTree]")
+{
+  const size_t keys_count = 10'000'000;
+  std::vector<uint32_t> keys(keys_count);
+  for (size_t i = 0; i < keys_count; i++) keys[i] = (uint32_t)(i * 3);
+
+  auto tree = core::trees::EytzingerTree<uint32_t>(keys);
+
+  std::vector<uint32_t> lookups(1 << 20);
+  for (size_t i = 0; i < lookups.size(); i++)
+  {
+    lookups[i] = (uint32_t)random_keys.at(i, keys_count * 3);
+  }
+
+  BENCHMARK("std::lower_bound")
+  {
+    uint64_t sum = 0;
+    for (const auto key : lookups) sum += *std::ranges::lower_bound(keys, key);
+    return sum;
+  };
+
+  BENCHMARK("EytzingerTree")
+  {
+    uint64_t sum = 0;
+    for (const auto key : lookups) sum += *tree.lower_bound(key);
+    return sum;
+  };
+}
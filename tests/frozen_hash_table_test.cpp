@@ -0,0 +1,124 @@
+#include "catch2/catch_all.hpp"
+#include "hash_table.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+TEST_CASE("it should be able to correctly get elements",
+          "[FrozenHashTable, external]")
+{
+  const std::vector<size_t> keys = {0, 3, 11, 12, 6, 14};
+  const std::vector<int> values = {1, 2, 3, 4, 5, 6};
+
+  auto hash_table = core::hash_table::FrozenHashTable<int>(keys, values);
+
+  for (size_t i = 0; i < keys.size(); i++)
+  {
+    auto element = hash_table.get(keys[i]);
+    REQUIRE(element.has_value());
+    REQUIRE(*element == values[i]);
+  }
+
+  REQUIRE_FALSE(hash_table.get(100).has_value());
+  REQUIRE(hash_table.find(1) == nullptr);
+  REQUIRE(hash_table.size() == keys.size());
+}
+
+TEST_CASE("it should find every key of a large key set",
+          "[FrozenHashTable, external]")
+{
+  const size_t count = 200000;
+  std::vector<size_t> keys(count);
+  std::vector<size_t> values(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    keys[i] = i * 7919;
+    values[i] = i;
+  }
+
+  auto hash_table = core::hash_table::FrozenHashTable<size_t>(keys, values);
+
+  for (size_t i = 0; i < count; i++) REQUIRE(*hash_table.find(keys[i]) == i);
+  for (size_t i = 0; i < count; i++)
+  {
+    REQUIRE(hash_table.find(i * 7919 + 1) == nullptr);
+  }
+}
+
+TEST_CASE("it should take less than 4 bits of index per key",
+          "[FrozenHashTable, internal]")
+{
+  const size_t count = 1 << 20;
+  std::vector<size_t> keys(count);
+  for (size_t i = 0; i < count; i++) keys[i] = i;
+
+  auto hash_table = core::hash_table::FrozenHashTable<size_t>(keys, keys);
+
+  REQUIRE(hash_table.index_bits_per_key() < 4);
+}
+
+TEST_CASE("it should build the same table with any number of threads",
+          "[FrozenHashTable, internal]")
+{
+  const size_t count = 300000;
+  std::vector<size_t> keys(count);
+  for (size_t i = 0; i < count; i++) keys[i] = i * i;
+
+  auto single = core::hash_table::FrozenHashTable<size_t>(keys, keys, 1);
+  auto parallel = core::hash_table::FrozenHashTable<size_t>(keys, keys, 4);
+
+  REQUIRE(std::ranges::equal(single, parallel));
+  for (const auto key : keys) REQUIRE(*parallel.find(key) == key);
+}
+
+TEST_CASE("it should lay its elements out densely",
+          "[FrozenHashTable, internal]")
+{
+  const std::vector<size_t> keys = {40, 10, 30, 20};
+  const std::vector<int> values = {1, 2, 3, 4};
+
+  auto hash_table = core::hash_table::FrozenHashTable<int>(keys, values);
+
+  auto elements = std::vector(hash_table.begin(), hash_table.end());
+  std::ranges::sort(elements);
+  const std::vector<std::pair<size_t, int>> expected = {
+      std::pair(10, 2), std::pair(20, 4), std::pair(30, 3), std::pair(40, 1)};
+  REQUIRE(elements == expected);
+}
+
+TEST_CASE("it should refuse duplicate keys and missing values",
+          "[FrozenHashTable, external]")
+{
+  using Table = core::hash_table::FrozenHashTable<int>;
+  const std::vector<size_t> duplicated = {1, 2, 3, 2};
+  const std::vector<int> values = {1, 2, 3, 4};
+
+  REQUIRE_THROWS_AS(Table(duplicated, values), std::invalid_argument);
+  REQUIRE_THROWS_AS(Table(duplicated, std::span(values).first(2)),
+                    std::invalid_argument);
+}
+
+TEST_CASE("it should build an empty table", "[FrozenHashTable, external]")
+{
+  auto hash_table = core::hash_table::FrozenHashTable<int>({}, {});
+
+  REQUIRE(hash_table.size() == 0);
+  REQUIRE(hash_table.find(0) == nullptr);
+}
+
+TEST_CASE("it should look string keys up by string views",
+          "[FrozenHashTable, external]")
+{
+  const std::vector<std::string> keys = {"one", "two", "three"};
+  const std::vector<int> values = {1, 2, 3};
+
+  auto hash_table =
+      core::hash_table::FrozenHashTable<int, std::string>(keys, values);
+
+  REQUIRE(*hash_table.find(std::string("two")) == 2);
+  REQUIRE(*hash_table.find(std::string_view("three")) == 3);
+  REQUIRE(hash_table.find(std::string_view("four")) == nullptr);
+}
@@ -0,0 +1,129 @@
+#include "catch2/catch_all.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE("it should generate the same data whatever the thread count",
+          "[Generator, external]")
+{
+  const size_t size = 100003;
+  const auto single = core::utils::Generator(42, 1);
+
+  for (const size_t threads : {2, 3, 8})
+  {
+    const auto parallel = core::utils::Generator(42, threads);
+
+    REQUIRE(parallel.uniform(size) == single.uniform(size));
+    REQUIRE(parallel.uniform(size, 1000) == single.uniform(size, 1000));
+    REQUIRE(parallel.zipfian(size, 5000) == single.zipfian(size, 5000));
+    REQUIRE(parallel.normal(size) == single.normal(size));
+    REQUIRE(parallel.permutation(size) == single.permutation(size));
+    REQUIRE(parallel.runs(size, 64) == single.runs(size, 64));
+    REQUIRE(parallel.few_unique(size, 10) == single.few_unique(size, 10));
+  }
+
+  REQUIRE(core::utils::Generator(43).uniform(size) != single.uniform(size));
+}
+
+TEST_CASE("it should generate uniform numbers without bias",
+          "[Generator, internal]")
+{
+  const size_t size = 1 << 20;
+  const auto generator = core::utils::Generator(7);
+
+  // 3 doesn't divide 2^64, so the modulo of a 64-bit number would be biased.
+  const auto numbers = generator.uniform(size, 3);
+  size_t counts[3] = {};
+  for (const auto number : numbers)
+  {
+    REQUIRE(number < 3);
+    counts[number]++;
+  }
+  for (const auto count : counts)
+  {
+    REQUIRE(std::abs((double)count - size / 3.0) < size * 0.005);
+  }
+
+  const auto wide = generator.uniform(size);
+  REQUIRE(std::ranges::any_of(wide, [](uint64_t n) { return n >> 63; }));
+  REQUIRE_THROWS_AS(generator.uniform(size, 0), std::invalid_argument);
+}
+
+TEST_CASE("it should shuffle every number exactly once",
+          "[Generator, external]")
+{
+  for (const size_t size : {0, 1, 2, 1000, 100000})
+  {
+    auto permutation = core::utils::Generator(size).permutation(size);
+    REQUIRE(permutation.size() == size);
+    if (size > 2) REQUIRE_FALSE(std::ranges::is_sorted(permutation));
+
+    std::ranges::sort(permutation);
+    for (size_t i = 0; i < size; i++) REQUIRE(permutation[i] == i);
+  }
+}
+
+TEST_CASE("it should follow the requested distributions",
+          "[Generator, internal]")
+{
+  const size_t size = 1 << 18;
+  const auto generator = core::utils::Generator(1234);
+
+  const auto ranks = generator.zipfian(size, 1000);
+  std::vector<size_t> counts(1000);
+  for (const auto rank : ranks) counts.at(rank)++;
+  REQUIRE(std::ranges::max_element(counts) == counts.begin());
+  REQUIRE(counts[0] > counts[10] * 5);
+
+  const auto normal = generator.normal(size, 10, 2);
+  const auto mean = std::accumulate(normal.begin(), normal.end(), 0.0) / size;
+  double variance = 0;
+  for (const auto number : normal) variance += std::pow(number - mean, 2);
+  REQUIRE(std::abs(mean - 10) < 0.02);
+  REQUIRE(std::abs(std::sqrt(variance / size) - 2) < 0.02);
+
+  const auto sorted = generator.sorted(size);
+  REQUIRE(std::ranges::is_sorted(sorted));
+  REQUIRE(sorted.back() == size - 1);
+
+  const auto reversed = generator.reversed(size);
+  REQUIRE(std::ranges::is_sorted(reversed, std::greater()));
+
+  const auto runs = generator.runs(size, 100);
+  for (size_t i = 0; i < size; i++)
+  {
+    if (i % 100 != 0) REQUIRE(runs[i] == runs[i - 1] + 1);
+  }
+
+  const auto few = generator.few_unique(size, 16);
+  REQUIRE(std::set(few.begin(), few.end()).size() == 16);
+}
+
+TEST_CASE("it should keep the ints generators within their bounds",
+          "[Generator, external]")
+{
+  const auto numbers = core::utils::generate_random_ints_vector(10000, 3, 200);
+  REQUIRE(std::ranges::all_of(numbers,
+                              [](int n) { return n >= 0 && n < 200; }));
+  REQUIRE(numbers == core::utils::generate_random_ints_vector(10000, 3, 200));
+
+  // numbers up to `INT_MAX` are fine, greater ones would wrap around.
+  const auto max_int = (size_t)std::numeric_limits<int>::max();
+  REQUIRE(std::ranges::all_of(
+      core::utils::generate_random_ints_vector(10000, 3, max_int + 1),
+      [](int n) { return n >= 0; }));
+  REQUIRE_THROWS_AS(core::utils::generate_random_ints_vector(1, 3, max_int + 2),
+                    std::invalid_argument);
+  REQUIRE_THROWS_AS(core::utils::generate_random_ints_vector(1, 3, 0),
+                    std::invalid_argument);
+
+  auto shuffled = core::utils::generate_distinct_shuffled_ints_vector(500, 9);
+  std::ranges::sort(shuffled);
+  for (int i = 0; i < 500; i++) REQUIRE(shuffled[i] == i);
+}
@@ -0,0 +1,218 @@
+#include "benchmark_suite.hpp"
+#include "catch2/catch_all.hpp"
+#include "hash_table.hpp"
+#include "utils.hpp"
+#include <cmath>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * A suite comparing `OAHashTable` — with each probing policy — `SCHashTable`
+ * and `std::unordered_map` across table sizes, load factors and key
+ * distributions. It's hidden from the default run, since it takes minutes:
+ *
+ *   estrutura-de-dados-test "[hash_table_suite]"
+ *
+ * Tables span from L1-resident up to `HASH_TABLE_BENCHMARK_MAX_BYTES` of
+ * elements (64 MiB by default, 4 GiB at most), skipping sizes larger than
+ * half the physical memory. The results are written as JSON to
+ * `HASH_TABLE_BENCHMARK_OUTPUT`, or to the standard output if it's unset.
+ */
+
+namespace
+{
+
+using namespace suite;
+
+/**
+ * Runs every operation of the suite over a fresh table built by `make`, whose
+ * `insert`, `get` and `remove` behave as those of `HashTable`.
+ */
+template <typename Make>
+Result measure(const std::string &table_name, size_t bytes,
+               double load_factor, Distribution distribution,
+               const Workload &workload, Make &&make)
+{
+  const auto count = workload.keys.size();
+  auto result = Result();
+  result.set("table", table_name)
+      .set("bytes", bytes)
+      .set("elements", count)
+      .set("load_factor", load_factor)
+      .set("distribution", name_of(distribution));
+
+  core::utils::reset_peak_rss();
+  const auto baseline_rss = core::utils::current_rss();
+
+  {
+    auto table = make();
+    size_t found = 0;
+
+    const auto insert_ns = nanoseconds_per_operation(
+        count,
+        [&]
+        {
+          for (size_t i = 0; i < count; i++) table.insert(workload.keys[i], i);
+        });
+
+    const auto get_hit_ns = nanoseconds_per_operation(
+        count,
+        [&]
+        {
+          for (const auto key : workload.lookups)
+          {
+            found += table.get(key).has_value();
+          }
+        });
+
+    const auto get_miss_ns = nanoseconds_per_operation(
+        count,
+        [&]
+        {
+          for (const auto key : workload.absent_keys)
+          {
+            found += table.get(key).has_value();
+          }
+        });
+
+    // replaces every key with an absent one, one at a time, while looking up
+    // the keys inserted so far.
+    const auto churn_ns = nanoseconds_per_operation(
+        count * 3,
+        [&]
+        {
+          for (size_t i = 0; i < count; i++)
+          {
+            table.remove(workload.keys[i]);
+            table.insert(workload.absent_keys[i], i);
+            found += table.get(workload.absent_keys[i / 2]).has_value();
+          }
+        });
+
+    const auto remove_ns = nanoseconds_per_operation(
+        count,
+        [&]
+        {
+          for (const auto key : workload.absent_keys) table.remove(key);
+        });
+
+    // keeps the lookups from being optimized away.
+    REQUIRE(found >= count);
+
+    result.set("insert_ns", insert_ns)
+        .set("get_hit_ns", get_hit_ns)
+        .set("get_miss_ns", get_miss_ns)
+        .set("churn_ns", churn_ns)
+        .set("remove_ns", remove_ns);
+  }
+
+  return result.set("baseline_rss_bytes", baseline_rss)
+      .set("peak_rss_bytes", core::utils::peak_rss());
+}
+
+/**
+ * Gives `std::unordered_map` the same interface as the hash tables.
+ */
+class UnorderedMap
+{
+private:
+  std::unordered_map<size_t, size_t> map;
+
+public:
+  UnorderedMap(size_t capacity, double load_factor)
+  {
+    this->map.max_load_factor((float)load_factor);
+    this->map.reserve(capacity);
+  }
+
+  void insert(size_t key, size_t value)
+  {
+    this->map.insert_or_assign(key, value);
+  }
+
+  std::optional<size_t> get(size_t key)
+  {
+    const auto iterator = this->map.find(key);
+    if (iterator == this->map.end()) return std::nullopt;
+    return iterator->second;
+  }
+
+  void remove(size_t key) { this->map.erase(key); }
+};
+
+size_t max_bytes()
+{
+  const auto max_bytes = limit_from_environment(
+      "HASH_TABLE_BENCHMARK_MAX_BYTES", 64ull << 20, 4ull << 30);
+  return std::min(max_bytes, physical_memory() / 2);
+}
+
+} // namespace
+
+TEST_CASE("Hash tables across sizes, load factors and distributions",
+          "[.][benchmark][hash_table_suite]")
+{
+  using namespace core::hash_table;
+
+  // 16 KiB and 256 KiB fit the L1 and L2 caches, 4 MiB fits most L3 caches.
+  const size_t sizes[] = {16ull << 10, 256ull << 10, 4ull << 20,
+                          64ull << 20, 1ull << 30,   4ull << 30};
+  const double load_factors[] = {0.25, 0.5, 0.75, 0.9};
+  const auto element_size = sizeof(size_t) * 2;
+
+  std::vector<Result> results;
+
+  for (const auto bytes : sizes)
+  {
+    if (bytes > max_bytes()) break;
+    const auto count = bytes / element_size;
+
+    for (const auto distribution : distributions)
+    {
+      const auto workload = Workload(count, distribution);
+
+      for (const auto load_factor : load_factors)
+      {
+        const auto capacity = (size_t)std::ceil((double)count / load_factor);
+
+        // the table grows to stay at most half full. Forcing it fuller fills
+        // it with tombstones under churn, until every miss scans it whole.
+        if (load_factor <= 0.5)
+        {
+          results.push_back(measure(
+              "OAHashTable", bytes, load_factor, distribution, workload,
+              [&] { return OAHashTable<size_t>(capacity); }));
+
+          using Quadratic =
+              OAHashTable<size_t, size_t, Hash<size_t>, QuadraticProbing>;
+          results.push_back(measure(
+              "OAHashTable<QuadraticProbing>", bytes, load_factor,
+              distribution, workload, [&] { return Quadratic(capacity); }));
+
+          using Double =
+              OAHashTable<size_t, size_t, Hash<size_t>, DoubleHashing>;
+          results.push_back(measure(
+              "OAHashTable<DoubleHashing>", bytes, load_factor, distribution,
+              workload, [&] { return Double(capacity); }));
+        }
+
+        results.push_back(measure(
+            "SCHashTable", bytes, load_factor, distribution, workload,
+            [&]
+            {
+              auto table = SCHashTable<size_t>(capacity);
+              table.max_load_factor((float)load_factor);
+              return table;
+            }));
+
+        results.push_back(measure(
+            "std::unordered_map", bytes, load_factor, distribution, workload,
+            [&] { return UnorderedMap(count, load_factor); }));
+      }
+    }
+  }
+
+  write_json(results, "HASH_TABLE_BENCHMARK_OUTPUT");
+}
@@ -0,0 +1,116 @@
+#include "catch2/catch_all.hpp"
+#include "hash_table.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace
+{
+
+std::string snapshot_path(const std::string &name)
+{
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+} // namespace
+
+TEST_CASE("it should serve every saved key from the mapped snapshot",
+          "[OAHashTable, MappedOAHashTable, external]")
+{
+  const auto path = snapshot_path("oa_hash_table_snapshot_test.bin");
+  auto hash_table = core::hash_table::OAHashTable<double>(4);
+
+  for (size_t key = 0; key < 1000; key++) hash_table.insert(key * 3, key / 2.0);
+  for (size_t key = 0; key < 1000; key += 4) hash_table.remove(key * 3);
+
+  hash_table.save(path);
+
+  const auto mapped =
+      core::hash_table::OAHashTable<double>::open_mapped(path, true);
+  REQUIRE(mapped.size() == hash_table.size());
+  REQUIRE(mapped.capacity() == hash_table.capacity());
+
+  for (size_t key = 0; key < 3000; key++)
+  {
+    REQUIRE(mapped.get(key) == hash_table.get(key));
+  }
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("it should refuse snapshots of other types or corrupted ones",
+          "[MappedOAHashTable, internal]")
+{
+  const auto path = snapshot_path("oa_hash_table_corrupted_snapshot_test.bin");
+  auto hash_table = core::hash_table::OAHashTable<int>(8);
+  for (size_t key = 0; key < 3; key++) hash_table.insert(key, key);
+  hash_table.save(path);
+
+  SECTION("different value type")
+  {
+    using MappedTable = core::hash_table::MappedOAHashTable<double>;
+    REQUIRE_THROWS_AS(MappedTable(path), std::runtime_error);
+  }
+
+  SECTION("different probing policy")
+  {
+    using MappedTable =
+        core::hash_table::MappedOAHashTable<int, size_t,
+                                            core::hash_table::Hash<size_t>,
+                                            core::hash_table::DoubleHashing>;
+    REQUIRE_THROWS_AS(MappedTable(path), std::runtime_error);
+  }
+
+  SECTION("flipped row byte")
+  {
+    {
+      auto file = std::fstream(path, std::ios::binary | std::ios::in |
+                                         std::ios::out);
+      file.seekp(-1, std::ios::end);
+      file.put(0x7f);
+    }
+
+    using MappedTable = core::hash_table::MappedOAHashTable<int>;
+    REQUIRE_NOTHROW(MappedTable(path));
+    REQUIRE_THROWS_AS(MappedTable(path, true), std::runtime_error);
+  }
+
+  SECTION("not a snapshot")
+  {
+    {
+      auto file = std::ofstream(path, std::ios::binary | std::ios::trunc);
+      file << "definitely not a hash table";
+    }
+
+    using MappedTable = core::hash_table::MappedOAHashTable<int>;
+    REQUIRE_THROWS_AS(MappedTable(path), std::runtime_error);
+  }
+
+  SECTION("missing file")
+  {
+    using MappedTable = core::hash_table::MappedOAHashTable<int>;
+    REQUIRE_THROWS_AS(MappedTable(path + ".missing"), std::runtime_error);
+  }
+
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("it should probe mapped snapshots as the saved table did",
+          "[MappedOAHashTable, external]")
+{
+  using namespace core::hash_table;
+  using Table = OAHashTable<int, size_t, Hash<size_t>, QuadraticProbing>;
+
+  const auto path = snapshot_path("oa_hash_table_quadratic_snapshot_test.bin");
+  auto hash_table = Table(4);
+  for (size_t key = 0; key < 500; key++) hash_table.insert(key * 64, key);
+  hash_table.save(path);
+
+  const auto mapped = Table::open_mapped(path);
+  for (size_t key = 0; key < 1000; key++)
+  {
+    REQUIRE(mapped.get(key * 32) == hash_table.get(key * 32));
+  }
+
+  std::filesystem::remove(path);
+}
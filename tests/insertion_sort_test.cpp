@@ -24,9 +24,20 @@ TEST_CASE("it should correctly shift elements `steps` to the right",
 {
   using core::sort_algorithms::internal::shift_right;
   auto vec = std::vector{3, 4, 5, 6, 1};
-  const auto expected = std::span<const int>({3, 3, 4, 5, 6});
+  const int expected[] = {3, 3, 4, 5, 6};
 
   const size_t position_of_el_1 = 4;
   shift_right(vec.data(), vec.data() + position_of_el_1, 1);
   REQUIRE(std::ranges::equal(vec, expected));
 }
+
+TEST_CASE("it should keep every element while ordering",
+          "[insertion_sort, external]")
+{
+  auto vector = core::utils::generate_random_ints_vector(1000, 7, 50);
+  auto expected = vector;
+  std::ranges::sort(expected);
+
+  core::sort_algorithms::insertion_sort<int>(vector);
+  REQUIRE(vector == expected);
+}
@@ -0,0 +1,127 @@
+#include "cache.hpp"
+#include "catch2/catch_all.hpp"
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+TEST_CASE("it should evict the least recently used entry",
+          "[LRUCache, external]")
+{
+  auto cache = core::cache::LRUCache<int>(3);
+
+  cache.put(1, 10);
+  cache.put(2, 20);
+  cache.put(3, 30);
+  REQUIRE(*cache.get(1) == 10);
+
+  cache.put(4, 40);
+
+  REQUIRE(cache.size() == 3);
+  REQUIRE_FALSE(cache.contains(2));
+  REQUIRE(*cache.get(1) == 10);
+  REQUIRE(*cache.get(3) == 30);
+  REQUIRE(*cache.get(4) == 40);
+}
+
+TEST_CASE("it should replace values and count them as uses",
+          "[LRUCache, external]")
+{
+  auto cache = core::cache::LRUCache<int>(2);
+
+  cache.put(1, 10);
+  cache.put(2, 20);
+  cache.put(1, 11);
+  cache.put(3, 30);
+
+  REQUIRE(*cache.get(1) == 11);
+  REQUIRE_FALSE(cache.get(2).has_value());
+  REQUIRE(cache.size() == 2);
+}
+
+TEST_CASE("it should count hits, misses and evictions",
+          "[LRUCache, external]")
+{
+  auto cache = core::cache::LRUCache<int>(2);
+
+  cache.put(1, 10);
+  cache.put(2, 20);
+  cache.put(3, 30);
+  cache.get(1);
+  cache.get(2);
+  cache.get(3);
+  REQUIRE(cache.contains(3));
+
+  const auto stats = cache.stats();
+  REQUIRE(stats.hits == 2);
+  REQUIRE(stats.misses == 1);
+  REQUIRE(stats.evictions == 1);
+  REQUIRE(stats.hit_ratio() == Catch::Approx(2.0 / 3));
+}
+
+TEST_CASE("it should evict and remove entries explicitly",
+          "[LRUCache, external]")
+{
+  auto cache = core::cache::LRUCache<int>(3);
+  for (size_t key = 0; key < 3; key++) cache.put(key, (int)key);
+  cache.get(0);
+
+  REQUIRE(cache.evict() == std::pair<size_t, int>(1, 1));
+  REQUIRE(cache.remove(0));
+  REQUIRE_FALSE(cache.remove(0));
+  REQUIRE(cache.size() == 1);
+
+  // removed slots are filled before evicting anything.
+  cache.put(5, 5);
+  cache.put(6, 6);
+  REQUIRE(cache.stats().evictions == 1);
+  REQUIRE(cache.size() == 3);
+
+  cache.put(7, 7);
+  REQUIRE_FALSE(cache.contains(2));
+  REQUIRE(cache.evict()->first == 5);
+  REQUIRE(cache.evict()->first == 6);
+  REQUIRE(cache.evict()->first == 7);
+  REQUIRE_FALSE(cache.evict().has_value());
+}
+
+TEST_CASE("it should keep the most recent keys under churn",
+          "[LRUCache, internal]")
+{
+  const size_t capacity = 1000;
+  auto cache = core::cache::LRUCache<size_t>(capacity);
+
+  for (size_t key = 0; key < capacity * 20; key++)
+  {
+    cache.put(key, key * 2);
+    REQUIRE(cache.size() == std::min(key + 1, capacity));
+  }
+
+  for (size_t key = capacity * 19; key < capacity * 20; key++)
+  {
+    REQUIRE(*cache.find(key) == key * 2);
+  }
+  REQUIRE_FALSE(cache.contains(capacity * 19 - 1));
+}
+
+TEST_CASE("it should size itself to a memory budget", "[LRUCache, external]")
+{
+  auto cache = core::cache::LRUCache<size_t>::with_memory_budget(1 << 20);
+
+  REQUIRE(cache.capacity() > 0);
+  REQUIRE(cache.capacity() < (1 << 20) / (sizeof(size_t) * 2));
+  REQUIRE_THROWS_AS(core::cache::LRUCache<size_t>(0), std::invalid_argument);
+}
+
+TEST_CASE("it should look string keys up by string views",
+          "[LRUCache, external]")
+{
+  auto cache = core::cache::LRUCache<int, std::string>(2);
+
+  cache.put("one", 1);
+  cache.put("two", 2);
+
+  REQUIRE(*cache.find(std::string_view("one")) == 1);
+  cache.put("three", 3);
+  REQUIRE(cache.find(std::string_view("two")) == nullptr);
+}
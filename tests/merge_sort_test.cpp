@@ -44,8 +44,8 @@ TEST_CASE("it should create subvectors from some window of a vector",
     auto subvector_as_span =
         std::span<const int>(subvector.get(), subvector_size);
 
-    auto expected = std::span<const int>({1, 2, 3});
-    auto unexpected = std::span<const int>({2, 3, 4});
+    const int expected[] = {1, 2, 3};
+    const int unexpected[] = {2, 3, 4};
 
     REQUIRE(std::ranges::equal(subvector_as_span, expected));
     REQUIRE_FALSE(std::ranges::equal(subvector_as_span, unexpected));
@@ -57,8 +57,8 @@ TEST_CASE("it should create subvectors from some window of a vector",
     auto subvector_as_span =
         std::span<const int>(subvector.get(), subvector_size);
 
-    auto expected = std::span<const int>({4, 5, 6});
-    auto unexpected = std::span<const int>({3, 4, 5});
+    const int expected[] = {4, 5, 6};
+    const int unexpected[] = {3, 4, 5};
 
     REQUIRE(std::ranges::equal(subvector_as_span, expected));
     REQUIRE_FALSE(std::ranges::equal(subvector_as_span, unexpected));
@@ -74,14 +74,15 @@ TEST_CASE("it should correctly interleave the sorted subvectors",
   int initial_vector[] = {10, 11, 12, 4, 5, 6};
 
   interleave(InterleaveArgs<int>{
-      .left_subvec = copy_to_subvector(initial_vector, 3),
+      .target_vector = initial_vector,
       .right_subvec = copy_to_subvector(initial_vector + 3, 3),
+      .left_subvec = copy_to_subvector(initial_vector, 3),
       .left_subvector_size = 3,
       .right_subvector_size = 3,
-      .target_vector = initial_vector,
-      .vector_central_element_pos = 2,
-      .vector_last_element_pos = 5,
       .vector_first_element_pos = 0,
+      .vector_last_element_pos = 5,
+      .vector_central_element_pos = 2,
+      .meta = nullptr,
   });
 
   REQUIRE(std::ranges::equal(initial_vector, std::vector{4, 5, 6, 10, 11, 12}));
@@ -173,3 +174,12 @@ TEST_CASE("it should count the inversions occurrence in the given vector",
     REQUIRE(metadata_2.inversions_count == expected_inversions_count);
   }
 }
+
+TEST_CASE("it should leave empty vectors alone",
+          "[merge_sort, iteratively_merge_sort, external]")
+{
+  auto empty = std::vector<int>();
+  REQUIRE(core::sort_algorithms::merge_sort<int>(empty).inversions_count == 0);
+  REQUIRE(core::sort_algorithms::iteratively_merge_sort<int>(empty)
+              .inversions_count == 0);
+}
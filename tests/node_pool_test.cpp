@@ -0,0 +1,73 @@
+#include "catch2/catch_all.hpp"
+#include "trees.hpp"
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+TEST_CASE("it should hand out distinct indices to live nodes",
+          "[NodePool, external]")
+{
+  auto pool = core::trees::NodePool<std::pair<int, int>>();
+  std::vector<uint32_t> indices;
+
+  for (int i = 0; i < 10000; i++) indices.push_back(pool.allocate(i, -i));
+
+  REQUIRE(pool.size() == 10000);
+  for (int i = 0; i < 10000; i++)
+  {
+    REQUIRE(pool[indices[i]] == std::pair(i, -i));
+  }
+}
+
+TEST_CASE("it should reuse freed slots, newest first", "[NodePool, internal]")
+{
+  auto pool = core::trees::NodePool<int>();
+  const auto first = pool.allocate(1);
+  const auto second = pool.allocate(2);
+  pool.allocate(3);
+
+  pool.free(first);
+  pool.free(second);
+
+  REQUIRE(pool.size() == 1);
+  REQUIRE(pool.allocate(4) == second);
+  REQUIRE(pool.allocate(5) == first);
+  REQUIRE(pool[first] == 5);
+}
+
+TEST_CASE("it should keep nodes in place when moved", "[NodePool, external]")
+{
+  auto pool = core::trees::NodePool<std::string>();
+  const auto index = pool.allocate("node");
+  const std::string *address = &pool[index];
+
+  auto moved = std::move(pool);
+
+  REQUIRE(&moved[index] == address);
+  REQUIRE(moved[index] == "node");
+  REQUIRE(pool.size() == 0);
+}
+
+TEST_CASE("it should destroy every live node along with the pool",
+          "[NodePool, internal]")
+{
+  auto counter = std::make_shared<int>(0);
+
+  {
+    auto pool = core::trees::NodePool<std::shared_ptr<int>>();
+    for (int i = 0; i < 5000; i++) pool.allocate(counter);
+    pool.free(10);
+    REQUIRE(counter.use_count() == 5000);
+  }
+
+  REQUIRE(counter.use_count() == 1);
+
+  auto pool = core::trees::NodePool<std::shared_ptr<int>>();
+  for (int i = 0; i < 100; i++) pool.allocate(counter);
+  pool.clear();
+
+  REQUIRE(counter.use_count() == 1);
+  REQUIRE(pool.size() == 0);
+  REQUIRE(pool.bytes() == 0);
+}
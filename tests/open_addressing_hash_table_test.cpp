@@ -1,5 +1,10 @@
 #include "catch2/catch_all.hpp"
 #include "hash_table.hpp"
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -215,3 +220,448 @@ TEST_CASE("it should resize when table is getting full",
   REQUIRE(hash_table.size() == 3);
   REQUIRE(hash_table.capacity() >= 4);
 }
+
+namespace
+{
+
+/// Counts how many times any instance has been copied.
+struct CopyCounter
+{
+  static inline size_t copies = 0;
+  int value = 0;
+
+  CopyCounter() = default;
+  CopyCounter(int value) : value(value) {}
+  CopyCounter(const CopyCounter &other) : value(other.value) { copies++; }
+  CopyCounter(CopyCounter &&other) = default;
+  CopyCounter &operator=(const CopyCounter &other)
+  {
+    this->value = other.value;
+    copies++;
+    return *this;
+  }
+  CopyCounter &operator=(CopyCounter &&other) = default;
+};
+
+} // namespace
+
+TEST_CASE("it should find values by reference", "[OAHashTable, external]")
+{
+  auto hash_table = core::hash_table::OAHashTable<int>(7);
+  hash_table.insert(3, 30);
+
+  REQUIRE(hash_table.find(4) == nullptr);
+
+  int *value = hash_table.find(3);
+  REQUIRE(value != nullptr);
+  REQUIRE(*value == 30);
+
+  *value = 31;
+  REQUIRE(*hash_table.get(3) == 31);
+}
+
+TEST_CASE("it should only construct values when inserting a new key",
+          "[OAHashTable, external]")
+{
+  auto hash_table = core::hash_table::OAHashTable<std::vector<int>>(7);
+
+  auto [inserted, is_insertion] = hash_table.try_emplace(1, 3, 7);
+  REQUIRE(is_insertion);
+  REQUIRE(*inserted == std::vector{7, 7, 7});
+
+  auto [existing, is_second_insertion] = hash_table.try_emplace(1, 10, 0);
+  REQUIRE_FALSE(is_second_insertion);
+  REQUIRE(existing == hash_table.find(1));
+  REQUIRE(*existing == std::vector{7, 7, 7});
+
+  auto [assigned, is_third_insertion] =
+      hash_table.insert_or_assign(1, std::vector{1});
+  REQUIRE_FALSE(is_third_insertion);
+  REQUIRE(*assigned == std::vector{1});
+  REQUIRE(hash_table.size() == 1);
+}
+
+TEST_CASE("it should not copy values that are moved in or looked up",
+          "[OAHashTable, internal]")
+{
+  auto hash_table = core::hash_table::OAHashTable<CopyCounter>(2);
+  CopyCounter::copies = 0;
+
+  for (size_t key = 0; key < 10; key++)
+  {
+    hash_table.insert(key, CopyCounter(key));
+    hash_table.try_emplace(key + 10, (int)key);
+    hash_table.insert_or_assign(key, CopyCounter(key + 1));
+  }
+
+  for (size_t key = 0; key < 10; key++)
+  {
+    REQUIRE(hash_table.find(key)->value == (int)key + 1);
+  }
+
+  REQUIRE(CopyCounter::copies == 0);
+}
+
+TEST_CASE("it should look string keys up by string views",
+          "[OAHashTable, external]")
+{
+  auto hash_table = core::hash_table::OAHashTable<int, std::string>(7);
+  hash_table.insert("one", 1);
+  hash_table.try_emplace(std::string("two"), 2);
+
+  const auto key = std::string_view("two and a half").substr(0, 3);
+  REQUIRE(hash_table.find(key) != nullptr);
+  REQUIRE(*hash_table.find(key) == 2);
+  REQUIRE(*hash_table.find("one") == 1);
+  REQUIRE(hash_table.find(std::string_view("three")) == nullptr);
+}
+
+TEST_CASE("it should get and insert keys in batches",
+          "[OAHashTable, external]")
+{
+  auto hash_table = core::hash_table::OAHashTable<int>(4);
+
+  std::vector<size_t> keys;
+  std::vector<int> values;
+  for (size_t key = 0; key < 1000; key++)
+  {
+    keys.push_back(key * 7);
+    values.push_back(key);
+  }
+  // the last occurrence of a repeated key should win.
+  keys.push_back(0);
+  values.push_back(-1);
+
+  hash_table.insert_batch(keys, values);
+  REQUIRE(hash_table.size() == 1000);
+
+  for (const size_t prefetch_distance : {0, 1, 16, 10000})
+  {
+    std::vector<size_t> lookups = {0, 7, 8, 6993, 6994, 14};
+    std::vector<std::optional<int>> results(lookups.size());
+    hash_table.get_batch(lookups, results, prefetch_distance);
+
+    REQUIRE(results[0] == -1);
+    REQUIRE(results[1] == 1);
+    REQUIRE_FALSE(results[2].has_value());
+    REQUIRE(results[3] == 999);
+    REQUIRE_FALSE(results[4].has_value());
+    REQUIRE(results[5] == 2);
+  }
+}
+
+TEST_CASE("it should reserve room for a batch at once",
+          "[OAHashTable, internal]")
+{
+  auto hash_table = core::hash_table::OAHashTable<int>(2);
+  hash_table.reserve(100);
+
+  const auto capacity = hash_table.capacity();
+  REQUIRE(capacity >= 200);
+
+  for (size_t key = 0; key < 100; key++) hash_table.insert(key, key);
+  REQUIRE(hash_table.capacity() == capacity);
+}
+
+TEST_CASE("it should keep half the rows free on batches among tombstones",
+          "[OAHashTable, internal]")
+{
+  auto hash_table = core::hash_table::OAHashTable<int>(1024);
+  REQUIRE(hash_table.capacity() == 1024);
+
+  // removes down to an eighth full, which leaves tombstones without shrinking.
+  for (size_t key = 0; key < 500; key++) hash_table.insert(key, key);
+  for (size_t key = 0; key < 370; key++) hash_table.remove(key);
+  REQUIRE(hash_table.capacity() == 1024);
+  REQUIRE(hash_table.stats().tombstone_ratio > 0.3);
+
+  std::vector<size_t> keys;
+  for (size_t key = 1000; key < 1300; key++) keys.push_back(key);
+  hash_table.insert_batch(keys, std::vector<int>(keys.size(), 1));
+
+  const auto stats = hash_table.stats();
+  REQUIRE(stats.size == 430);
+  REQUIRE(stats.size + stats.tombstone_ratio * stats.capacity <=
+          stats.capacity / 2);
+  for (size_t key = 370; key < 500; key++) REQUIRE(hash_table.get(key) == key);
+  for (const auto key : keys) REQUIRE(hash_table.get(key) == 1);
+}
+
+TEST_CASE("Batched versus scalar OAHashTable lookups",
+          "[benchmark][OAHashTable]")
+{
+  const size_t keys_count = 1 << 22;
+  auto hash_table = core::hash_table::OAHashTable<size_t>(keys_count * 2);
+
+  std::vector<size_t> keys(keys_count);
+  size_t state = 1;
+  for (auto &key : keys)
+  {
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    key = state >> 16;
+  }
+  hash_table.insert_batch(keys, keys);
+
+  std::vector<std::optional<size_t>> results(keys_count);
+
+  BENCHMARK("scalar get")
+  {
+    for (size_t i = 0; i < keys_count; i++)
+    {
+      results[i] = hash_table.get(keys[i]);
+    }
+    return results.back();
+  };
+
+  BENCHMARK("get_batch")
+  {
+    hash_table.get_batch(keys, results);
+    return results.back();
+  };
+}
+
+TEST_CASE("it should iterate over every element exactly once",
+          "[OAHashTable, external]")
+{
+  auto hash_table = core::hash_table::OAHashTable<int>(4);
+  for (size_t key = 0; key < 100; key++) hash_table.insert(key, key * 2);
+  for (size_t key = 0; key < 100; key += 2) hash_table.remove(key);
+
+  std::vector<std::pair<size_t, int>> elements(hash_table.begin(),
+                                               hash_table.end());
+  std::ranges::sort(elements);
+
+  REQUIRE(elements.size() == 50);
+  for (size_t i = 0; i < elements.size(); i++)
+  {
+    REQUIRE(elements[i] == std::pair<size_t, int>(i * 2 + 1, (i * 2 + 1) * 2));
+  }
+
+  auto empty_table = core::hash_table::OAHashTable<int>(4);
+  REQUIRE(empty_table.begin() == empty_table.end());
+}
+
+TEST_CASE("it should report how its keys are spread", "[OAHashTable, stats]")
+{
+  auto hash_table = core::hash_table::OAHashTable<int>(10);
+  hash_table.forbid_resizing();
+
+  // 0, 10 and 20 all hash to the first row, 5 has its own row.
+  for (const size_t key : {0, 10, 20, 5}) hash_table.insert(key, key);
+  hash_table.remove(10);
+
+  const auto stats = hash_table.stats();
+  REQUIRE(stats.size == 3);
+  REQUIRE(stats.capacity == 10);
+  REQUIRE(stats.load_factor == Catch::Approx(0.3));
+  REQUIRE(stats.tombstone_ratio == Catch::Approx(0.1));
+  REQUIRE(stats.probe_histogram == std::vector<size_t>{0, 2, 0, 1});
+  REQUIRE(stats.longest_probe == 3);
+  REQUIRE(stats.mean_probe == Catch::Approx(5.0 / 3.0));
+  REQUIRE(stats.longest_cluster == 3);
+  REQUIRE(stats.resize_count == 0);
+}
+
+TEST_CASE("it should report clusters wrapping around the table's end",
+          "[OAHashTable, stats]")
+{
+  auto hash_table = core::hash_table::OAHashTable<int>(5);
+  hash_table.forbid_resizing();
+
+  for (const size_t key : {4, 9, 14}) hash_table.insert(key, key);
+
+  const auto stats = hash_table.stats();
+  REQUIRE(stats.longest_cluster == 3);
+  REQUIRE(stats.longest_probe == 3);
+}
+
+TEST_CASE("it should count resizes", "[OAHashTable, stats]")
+{
+  auto hash_table = core::hash_table::OAHashTable<int>(2);
+  for (size_t key = 0; key < 100; key++) hash_table.insert(key, key);
+
+  const auto stats = hash_table.stats();
+  REQUIRE(stats.resize_count == 7);
+  REQUIRE(stats.resize_duration.count() > 0);
+
+#ifdef CORE_HASH_TABLE_PROBE_COUNTERS
+  REQUIRE(stats.operations == 100);
+  REQUIRE(stats.operations_probes >= 100);
+#else
+  REQUIRE(stats.operations == 0);
+#endif
+}
+
+TEST_CASE("every probing sequence should visit each row exactly once",
+          "[OAHashTable, internal]")
+{
+  using namespace core::hash_table;
+
+  const auto visits_every_row = [](auto sequence, size_t capacity)
+  {
+    std::vector<bool> visited(capacity, false);
+    for (size_t step = 0; step < capacity; step++)
+    {
+      if (visited[sequence.row()]) return false;
+      visited[sequence.row()] = true;
+      sequence.next();
+    }
+    return true;
+  };
+
+  for (const size_t hash : {0ull, 1ull, 12345ull, 0xFFFFFFFFFFFFFFFFull})
+  {
+    REQUIRE(visits_every_row(LinearProbing::Sequence(hash, 10), 10));
+    REQUIRE(visits_every_row(QuadraticProbing::Sequence(hash, 64), 64));
+    REQUIRE(visits_every_row(DoubleHashing::Sequence(hash, 64), 64));
+    REQUIRE(visits_every_row(DoubleHashing::Sequence(hash, 1), 1));
+  }
+}
+
+TEMPLATE_TEST_CASE("it should keep every key reachable whatever the probing",
+                   "[OAHashTable, external]",
+                   core::hash_table::LinearProbing,
+                   core::hash_table::QuadraticProbing,
+                   core::hash_table::DoubleHashing)
+{
+  using namespace core::hash_table;
+  using Table = OAHashTable<int, size_t, Hash<size_t>, TestType>;
+
+  SECTION("growing, with removals")
+  {
+    auto hash_table = Table(4);
+    for (size_t key = 0; key < 1000; key++) hash_table.insert(key * 16, key);
+    for (size_t key = 0; key < 1000; key += 3) hash_table.remove(key * 16);
+
+    for (size_t key = 0; key < 2000; key++)
+    {
+      const auto expected = key < 1000 && key % 3 ? std::optional<int>(key)
+                                                  : std::nullopt;
+      REQUIRE(hash_table.get(key * 16) == expected);
+    }
+
+    const auto stats = hash_table.stats();
+    size_t keys = 0;
+    for (const auto count : stats.probe_histogram) keys += count;
+    REQUIRE(keys == hash_table.size());
+    REQUIRE(stats.mean_probe >= 1);
+  }
+
+  SECTION("filling every row, then reusing tombstones")
+  {
+    auto hash_table = Table(16);
+    hash_table.forbid_resizing();
+
+    for (size_t key = 0; key < 16; key++) hash_table.insert(key * 7, key);
+    REQUIRE(hash_table.size() == 16);
+    REQUIRE_THROWS_AS(hash_table.insert(1000, 0), std::runtime_error);
+
+    for (size_t key = 0; key < 16; key += 2) hash_table.remove(key * 7);
+    for (size_t key = 16; key < 24; key++) hash_table.insert(key * 7, key);
+
+    for (size_t key = 0; key < 24; key++)
+    {
+      const auto expected =
+          key < 16 && key % 2 == 0 ? std::nullopt : std::optional<int>(key);
+      REQUIRE(hash_table.get(key * 7) == expected);
+    }
+  }
+}
+
+TEST_CASE("power of two probing policies should round capacities up",
+          "[OAHashTable, external]")
+{
+  using namespace core::hash_table;
+
+  REQUIRE(OAHashTable<int>(10).capacity() == 10);
+  REQUIRE(OAHashTable<int, size_t, Hash<size_t>, QuadraticProbing>(10)
+              .capacity() == 16);
+  REQUIRE(OAHashTable<int, size_t, Hash<size_t>, DoubleHashing>(0)
+              .capacity() == 1);
+}
+
+TEST_CASE("it should shrink after mass removals, down to its initial size",
+          "[OAHashTable, external]")
+{
+  auto hash_table = core::hash_table::OAHashTable<int>(8);
+  for (size_t key = 0; key < 10000; key++) hash_table.insert(key, key);
+  REQUIRE(hash_table.capacity() == 32768);
+
+  for (size_t key = 10; key < 10000; key++) hash_table.remove(key);
+  REQUIRE(hash_table.capacity() == 64);
+  for (size_t key = 0; key < 10; key++) REQUIRE(hash_table.get(key) == key);
+
+  for (size_t key = 0; key < 10; key++) hash_table.remove(key);
+  REQUIRE(hash_table.capacity() == 8);
+
+  auto presized = core::hash_table::OAHashTable<int>(1024);
+  for (size_t key = 0; key < 10; key++) presized.insert(key, key);
+  for (size_t key = 0; key < 10; key++) presized.remove(key);
+  REQUIRE(presized.capacity() == 1024);
+
+  auto fixed = core::hash_table::OAHashTable<int>(1024);
+  fixed.forbid_resizing();
+  for (size_t key = 0; key < 500; key++) fixed.insert(key, key);
+  for (size_t key = 0; key < 500; key++) fixed.remove(key);
+  REQUIRE(fixed.capacity() == 1024);
+}
+
+TEST_CASE("shrink_to_fit should leave the table half full and tombstone-free",
+          "[OAHashTable, external]")
+{
+  auto hash_table = core::hash_table::OAHashTable<int>(4);
+  for (size_t key = 0; key < 1000; key++) hash_table.insert(key, key);
+  for (size_t key = 100; key < 1000; key++) hash_table.remove(key);
+  REQUIRE(hash_table.capacity() == 512);
+
+  hash_table.shrink_to_fit();
+  REQUIRE(hash_table.capacity() == 200);
+  REQUIRE(hash_table.stats().tombstone_ratio == 0);
+  for (size_t key = 0; key < 100; key++) REQUIRE(hash_table.get(key) == key);
+}
+
+TEMPLATE_TEST_CASE("it should purge tombstones in place rather than grow",
+                   "[OAHashTable, external]",
+                   core::hash_table::LinearProbing,
+                   core::hash_table::QuadraticProbing,
+                   core::hash_table::DoubleHashing)
+{
+  using namespace core::hash_table;
+
+  auto hash_table = OAHashTable<int, size_t, Hash<size_t>, TestType>(64);
+  auto expected = std::unordered_map<size_t, int>();
+
+  // keeps about 20 keys alive while cycling through thousands.
+  uint64_t state = 1;
+  for (size_t i = 0; i < 20000; i++)
+  {
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    const auto key = (state >> 33) % 4096;
+
+    if (expected.size() < 20)
+    {
+      hash_table.insert(key, i);
+      expected[key] = i;
+    }
+    else
+    {
+      hash_table.remove(expected.begin()->first);
+      expected.erase(expected.begin());
+    }
+  }
+
+  const auto stats = hash_table.stats();
+  REQUIRE(stats.capacity == 64);
+  REQUIRE(stats.resize_count == 0);
+  REQUIRE(stats.purge_count > 0);
+  REQUIRE(stats.tombstone_ratio <= 0.5);
+  REQUIRE(hash_table.size() == expected.size());
+
+  for (size_t key = 0; key < 4096; key++)
+  {
+    const auto element = expected.find(key);
+    REQUIRE(hash_table.get(key) == (element == expected.end()
+                                        ? std::nullopt
+                                        : std::optional(element->second)));
+  }
+}
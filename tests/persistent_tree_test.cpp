@@ -0,0 +1,176 @@
+#include "catch2/catch_all.hpp"
+#include "trees.hpp"
+#include "utils.hpp"
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+/// Draws the keys of random operations.
+const auto random_keys = core::utils::Generator(0);
+/// Draws which random operation to run.
+const auto random_operations = core::utils::Generator(1);
+
+template <typename K, typename V>
+void require_same(const core::trees::PersistentTree<K, V> &tree,
+                  const std::map<K, V> &map)
+{
+  REQUIRE(tree.count() == map.size());
+
+  std::vector<std::pair<K, V>> pairs;
+  tree.for_each([&](const K &key, const V &value)
+                { pairs.emplace_back(key, value); });
+  REQUIRE(pairs == std::vector<std::pair<K, V>>(map.begin(), map.end()));
+}
+
+} // namespace
+
+TEST_CASE("it should be able to correctly insert and get elements",
+          "[PersistentTree, external]")
+{
+  std::vector<std::pair<int, int>> pairs = {
+      std::pair(0, 1),  std::pair(3, 2), std::pair(11, 3),
+      std::pair(12, 4), std::pair(6, 5), std::pair(14, 6)};
+
+  auto tree = core::trees::PersistentTree<int, int>();
+
+  for (const auto &pair : pairs) tree = tree.insert(pair.first, pair.second);
+  tree = tree.insert(14, 3);
+
+  for (const auto &pair : pairs)
+  {
+    const int *element = tree.get(pair.first);
+    REQUIRE(element != nullptr);
+    REQUIRE(*element == (pair.first == 14 ? 3 : pair.second));
+  }
+
+  REQUIRE(tree.get(100) == nullptr);
+  REQUIRE(tree.count() == pairs.size());
+}
+
+TEST_CASE("it should leave every older version unchanged",
+          "[PersistentTree, external]")
+{
+  auto versions = std::vector{core::trees::PersistentTree<int64_t, uint64_t>()};
+  auto maps = std::vector{std::map<int64_t, uint64_t>()};
+
+  for (uint64_t i = 0; i < 3000; i++)
+  {
+    const auto key = (int64_t)random_keys.at(i, 500) - 250;
+    auto map = maps.back();
+    if (random_operations.at(i, 5) < 2)
+    {
+      versions.push_back(versions.back().remove(key));
+      map.erase(key);
+    }
+    else
+    {
+      versions.push_back(versions.back().insert(key, i));
+      map.insert_or_assign(key, i);
+    }
+    maps.push_back(std::move(map));
+  }
+
+  for (size_t i = 0; i < versions.size(); i += 97)
+  {
+    require_same(versions[i], maps[i]);
+  }
+  require_same(versions.back(), maps.back());
+}
+
+TEST_CASE("it should stay balanced", "[PersistentTree, internal]")
+{
+  auto tree = core::trees::PersistentTree<uint32_t, uint32_t>();
+  const uint32_t count = 1 << 16;
+
+  for (uint32_t key = 0; key < count; key++) tree = tree.insert(key, key);
+  // an AVL tree is at most about 1.44 times as high as a perfect one.
+  REQUIRE(tree.height() <= 24);
+
+  for (uint32_t key = 0; key < count; key += 2) tree = tree.remove(key);
+  REQUIRE(tree.count() == count / 2);
+  REQUIRE(tree.height() <= 23);
+
+  for (uint32_t key = 0; key < count; key++)
+  {
+    REQUIRE((tree.find(key) != nullptr) == (key % 2 == 1));
+  }
+}
+
+TEST_CASE("it should visit ranges in order", "[PersistentTree, external]")
+{
+  auto tree = core::trees::PersistentTree<std::string, int>();
+  for (int i = 0; i < 100; i += 2) tree = tree.insert(std::to_string(i), i);
+
+  std::vector<int> values;
+  tree.for_each_in_range("3", "5", [&](const std::string &, const int &value)
+                         { values.push_back(value); });
+
+  REQUIRE(values ==
+          std::vector<int>{30, 32, 34, 36, 38, 4, 40, 42, 44, 46, 48});
+
+  values.clear();
+  tree.for_each_in_range("99", "999", [&](const std::string &, const int &value)
+                         { values.push_back(value); });
+  REQUIRE(values.empty());
+}
+
+TEST_CASE("it should let readers scan snapshots while writers go on",
+          "[VersionedTree, internal]")
+{
+  auto tree = core::trees::VersionedTree<uint32_t, uint32_t>();
+  const uint32_t count = 20000;
+  std::atomic<bool> done = false;
+
+  // the writer keeps every key's value equal to the key, and removes keys
+  // in the order it inserted them, so any snapshot holds a run of keys.
+  auto writer = std::thread(
+      [&]
+      {
+        for (uint32_t key = 0; key < count; key++)
+        {
+          tree.insert(key, key);
+          if (key >= 100) tree.remove(key - 100);
+        }
+        done = true;
+      });
+
+  std::vector<std::thread> readers;
+  std::atomic<size_t> failures = 0;
+  for (int i = 0; i < 3; i++)
+  {
+    readers.emplace_back(
+        [&]
+        {
+          while (!done)
+          {
+            const auto snapshot = tree.snapshot();
+            uint32_t expected = 0;
+            bool first = true;
+            size_t seen = 0;
+            snapshot.for_each(
+                [&](const uint32_t &key, const uint32_t &value)
+                {
+                  if (!first && key != expected) failures++;
+                  if (value != key) failures++;
+                  first = false;
+                  expected = key + 1;
+                  seen++;
+                });
+            if (seen != snapshot.count() || seen > 101) failures++;
+          }
+        });
+  }
+
+  writer.join();
+  for (auto &reader : readers) reader.join();
+
+  REQUIRE(failures == 0);
+  REQUIRE(tree.snapshot().count() == 100);
+}
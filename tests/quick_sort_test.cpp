@@ -13,6 +13,19 @@ TEST_CASE("it should sort a span-representable list")
   REQUIRE(std::is_sorted(input_vec.begin(), input_vec.end()));
 }
 
+TEST_CASE("it should sort lists of mostly repeated elements",
+          "[quick_sort, external]")
+{
+  // a few values repeated many times would take quadratic time, and as deep
+  // a recursion, if repeated elements weren't set aside.
+  auto input_vec = core::utils::generate_random_ints_vector(1000000, 1, 4);
+  auto expected = input_vec;
+  std::sort(expected.begin(), expected.end());
+
+  quick_sort<int>(input_vec);
+  REQUIRE(input_vec == expected);
+}
+
 TEST_CASE("Benchmarks de Alocação e Ordenação de Vetor", "[benchmark][vector]")
 {
   const size_t VECTOR_SIZE = 100000;
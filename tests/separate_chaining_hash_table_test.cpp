@@ -1,5 +1,11 @@
 #include "catch2/catch_all.hpp"
 #include "hash_table.hpp"
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -61,3 +67,189 @@ TEST_CASE("it should remove a value by key", "[SCHashTable, external]")
     REQUIRE_FALSE(element.has_value());
   }
 }
+
+TEST_CASE("it should find values by reference", "[SCHashTable, external]")
+{
+  auto hash_table = core::hash_table::SCHashTable<int>(7);
+  hash_table.insert(3, 30);
+
+  REQUIRE(hash_table.find(4) == nullptr);
+
+  int *value = hash_table.find(3);
+  REQUIRE(value != nullptr);
+  REQUIRE(*value == 30);
+
+  *value = 31;
+  REQUIRE(*hash_table.get(3) == 31);
+}
+
+TEST_CASE("it should only construct values when inserting a new key",
+          "[SCHashTable, external]")
+{
+  auto hash_table = core::hash_table::SCHashTable<std::vector<int>>(7);
+
+  auto [inserted, is_insertion] = hash_table.try_emplace(1, 3, 7);
+  REQUIRE(is_insertion);
+  REQUIRE(*inserted == std::vector{7, 7, 7});
+
+  auto [existing, is_second_insertion] = hash_table.try_emplace(1, 10, 0);
+  REQUIRE_FALSE(is_second_insertion);
+  REQUIRE(existing == hash_table.find(1));
+  REQUIRE(*existing == std::vector{7, 7, 7});
+
+  auto [assigned, is_third_insertion] =
+      hash_table.insert_or_assign(1, std::vector{1});
+  REQUIRE_FALSE(is_third_insertion);
+  REQUIRE(*assigned == std::vector{1});
+  REQUIRE(hash_table.size() == 1);
+}
+
+TEST_CASE("it should hold move-only values", "[SCHashTable, external]")
+{
+  auto hash_table = core::hash_table::SCHashTable<std::unique_ptr<int>>(7);
+
+  hash_table.try_emplace(1, std::make_unique<int>(10));
+  hash_table.insert_or_assign(1, std::make_unique<int>(20));
+
+  REQUIRE(hash_table.size() == 1);
+  REQUIRE(**hash_table.find(1) == 20);
+}
+
+TEST_CASE("it should look string keys up by string views",
+          "[SCHashTable, external]")
+{
+  auto hash_table = core::hash_table::SCHashTable<int, std::string>(7);
+  hash_table.insert("one", 1);
+  hash_table.try_emplace(std::string("two"), 2);
+
+  const auto key = std::string_view("two and a half").substr(0, 3);
+  REQUIRE(hash_table.find(key) != nullptr);
+  REQUIRE(*hash_table.find(key) == 2);
+  REQUIRE(*hash_table.find("one") == 1);
+  REQUIRE(hash_table.find(std::string_view("three")) == nullptr);
+}
+
+TEST_CASE("it should rehash when the load factor gets too high",
+          "[SCHashTable, internal]")
+{
+  auto hash_table = core::hash_table::SCHashTable<int>(2);
+  REQUIRE(hash_table.bucket_count() == 2);
+
+  for (size_t key = 0; key < 100; key++) hash_table.insert(key, key * 2);
+
+  REQUIRE(hash_table.size() == 100);
+  REQUIRE(hash_table.bucket_count() >= 100);
+  REQUIRE(hash_table.load_factor() <= hash_table.max_load_factor());
+
+  for (size_t key = 0; key < 100; key++)
+  {
+    REQUIRE(hash_table.get(key).has_value());
+    REQUIRE(*hash_table.get(key) == (int)key * 2);
+  }
+}
+
+TEST_CASE("it should reject max load factors that aren't positive",
+          "[SCHashTable, external]")
+{
+  auto hash_table = core::hash_table::SCHashTable<int>(2);
+  hash_table.insert(1, 1);
+
+  for (const float max_load_factor :
+       {0.0f, -1.0f, std::numeric_limits<float>::quiet_NaN(),
+        std::numeric_limits<float>::infinity()})
+  {
+    REQUIRE_THROWS_AS(hash_table.max_load_factor(max_load_factor),
+                      std::invalid_argument);
+  }
+
+  REQUIRE(hash_table.max_load_factor() == 1.0f);
+  REQUIRE(hash_table.bucket_count() == 2);
+
+  hash_table.max_load_factor(0.25f);
+  REQUIRE(hash_table.max_load_factor() == 0.25f);
+  REQUIRE(hash_table.bucket_count() >= 4);
+}
+
+TEST_CASE("it should relink nodes rather than moving them when rehashing",
+          "[SCHashTable, internal]")
+{
+  auto hash_table = core::hash_table::SCHashTable<int>(4);
+  for (size_t key = 0; key < 4; key++) hash_table.insert(key, key);
+
+  const int *value = hash_table.find(3);
+  hash_table.rehash(64);
+
+  REQUIRE(hash_table.bucket_count() == 64);
+  REQUIRE(hash_table.find(3) == value);
+}
+
+TEST_CASE("it should keep every remaining key reachable after removals",
+          "[SCHashTable, internal]")
+{
+  // every key collides into the same handful of buckets.
+  auto hash_table = core::hash_table::SCHashTable<int>(5);
+  hash_table.max_load_factor(100);
+
+  for (size_t key = 0; key < 50; key++) hash_table.insert(key * 5, key);
+  for (size_t key = 0; key < 50; key += 3) hash_table.remove(key * 5);
+
+  for (size_t key = 0; key < 50; key++)
+  {
+    auto element = hash_table.get(key * 5);
+    REQUIRE(element.has_value() == (key % 3 != 0));
+    if (element) REQUIRE(*element == (int)key);
+  }
+
+  REQUIRE(hash_table.size() == 33);
+  REQUIRE(hash_table.bucket_count() == 5);
+}
+
+TEST_CASE("it should iterate over every element exactly once",
+          "[SCHashTable, external]")
+{
+  auto hash_table = core::hash_table::SCHashTable<int>(4);
+  for (size_t key = 0; key < 100; key++) hash_table.insert(key, key * 2);
+  for (size_t key = 0; key < 100; key += 2) hash_table.remove(key);
+
+  std::vector<std::pair<size_t, int>> elements(hash_table.begin(),
+                                               hash_table.end());
+  std::ranges::sort(elements);
+
+  REQUIRE(elements.size() == 50);
+  for (size_t i = 0; i < elements.size(); i++)
+  {
+    REQUIRE(elements[i] == std::pair<size_t, int>(i * 2 + 1, (i * 2 + 1) * 2));
+  }
+
+  auto empty_table = core::hash_table::SCHashTable<int>(4);
+  REQUIRE(empty_table.begin() == empty_table.end());
+}
+
+TEST_CASE("it should report how its keys are spread", "[SCHashTable, stats]")
+{
+  auto hash_table = core::hash_table::SCHashTable<int>(5);
+  hash_table.max_load_factor(100);
+
+  // 0, 5 and 10 are chained in the first bucket, 1 has its own bucket.
+  for (const size_t key : {0, 5, 10, 1}) hash_table.insert(key, key);
+
+  const auto stats = hash_table.stats();
+  REQUIRE(stats.size == 4);
+  REQUIRE(stats.capacity == 5);
+  REQUIRE(stats.load_factor == Catch::Approx(0.8));
+  REQUIRE(stats.tombstone_ratio == 0);
+  REQUIRE(stats.probe_histogram == std::vector<size_t>{0, 2, 1, 1});
+  REQUIRE(stats.longest_probe == 3);
+  REQUIRE(stats.mean_probe == Catch::Approx(7.0 / 4.0));
+  REQUIRE(stats.longest_cluster == 3);
+  REQUIRE(stats.resize_count == 0);
+
+  hash_table.rehash(10);
+  REQUIRE(hash_table.stats().resize_count == 1);
+
+#ifdef CORE_HASH_TABLE_PROBE_COUNTERS
+  REQUIRE(hash_table.stats().operations == 4);
+#else
+  REQUIRE(hash_table.stats().operations == 0);
+#endif
+}
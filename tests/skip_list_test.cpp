@@ -0,0 +1,280 @@
+#include "catch2/catch_all.hpp"
+#include "trees.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+/// Draws the keys of random operations.
+const auto random_keys = core::utils::Generator(0);
+/// Draws which random operation to run.
+const auto random_operations = core::utils::Generator(1);
+
+} // namespace
+
+TEST_CASE("it should be able to correctly insert and get elements",
+          "[ConcurrentSkipList, external]")
+{
+  std::vector<std::pair<int, int>> pairs = {
+      std::pair(0, 1),  std::pair(3, 2), std::pair(11, 3),
+      std::pair(12, 4), std::pair(6, 5), std::pair(14, 6)};
+
+  auto list = core::trees::ConcurrentSkipList<int, int>();
+
+  for (const auto &pair : pairs) list.insert(pair.first, pair.second);
+  list.insert(14, 3);
+
+  for (const auto &pair : pairs)
+  {
+    auto element = list.get(pair.first);
+    REQUIRE(element.has_value());
+    REQUIRE(*element == (pair.first == 14 ? 3 : pair.second));
+  }
+
+  REQUIRE_FALSE(list.get(100).has_value());
+  REQUIRE(list.size() == pairs.size());
+}
+
+TEST_CASE("it should match std::map under random insertions and removals",
+          "[ConcurrentSkipList, internal]")
+{
+  auto list = core::trees::ConcurrentSkipList<std::string, uint64_t>();
+  auto map = std::map<std::string, uint64_t>();
+
+  for (uint64_t i = 0; i < 50000; i++)
+  {
+    const auto key = std::to_string(random_keys.at(i, 3000));
+    if (random_operations.at(i, 5) < 2)
+    {
+      list.remove(key);
+      map.erase(key);
+    }
+    else
+    {
+      list.insert(key, i);
+      map.insert_or_assign(key, i);
+    }
+  }
+
+  REQUIRE(list.size() == map.size());
+
+  using Pairs = std::vector<std::pair<std::string, uint64_t>>;
+  Pairs pairs;
+  list.for_each([&](const std::string &key, uint64_t value)
+                { pairs.emplace_back(key, value); });
+  REQUIRE(pairs == Pairs(map.begin(), map.end()));
+
+  pairs.clear();
+  list.for_each_in_range("15", "2", [&](const std::string &key, uint64_t value)
+                         { pairs.emplace_back(key, value); });
+  REQUIRE(pairs == Pairs(map.lower_bound("15"), map.lower_bound("2")));
+}
+
+TEST_CASE("it should not lose writes from concurrent writers",
+          "[ConcurrentSkipList, external]")
+{
+  const size_t threads_count = 4;
+  const size_t keys_per_thread = 20000;
+  auto list = core::trees::ConcurrentSkipList<size_t, size_t>();
+
+  // every thread inserts its own keys, and removes every other one of them.
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < threads_count; t++)
+  {
+    threads.emplace_back(
+        [&list, t]
+        {
+          for (size_t i = 0; i < keys_per_thread; i++)
+          {
+            const auto key = i * threads_count + t;
+            list.insert(key, key + 1);
+            if (i % 2 == 1) list.remove(key - threads_count);
+          }
+        });
+  }
+  for (auto &thread : threads) thread.join();
+
+  REQUIRE(list.size() == threads_count * keys_per_thread / 2);
+  for (size_t key = 0; key < threads_count * keys_per_thread; key++)
+  {
+    auto element = list.get(key);
+    REQUIRE(element.has_value() == ((key / threads_count) % 2 == 1));
+    if (element) REQUIRE(*element == key + 1);
+  }
+}
+
+TEST_CASE("readers should scan in order while keys come and go",
+          "[ConcurrentSkipList, internal]")
+{
+  const size_t keys_count = 2000;
+  auto list = core::trees::ConcurrentSkipList<size_t, size_t>();
+  std::atomic<size_t> done = 0;
+  std::atomic<size_t> inconsistencies = 0;
+
+  // even keys stay throughout, so every scan must see all of them.
+  for (size_t key = 0; key < keys_count; key += 2) list.insert(key, key * 3);
+
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < 2; t++)
+  {
+    threads.emplace_back(
+        [&, t]
+        {
+          for (size_t round = 0; round < 50; round++)
+          {
+            for (size_t key = 1 + t * 2; key < keys_count; key += 4)
+            {
+              list.insert(key, key * 3);
+            }
+            for (size_t key = 1 + t * 2; key < keys_count; key += 4)
+            {
+              list.remove(key);
+            }
+          }
+          done++;
+        });
+  }
+
+  threads.emplace_back(
+      [&]
+      {
+        while (done < 2)
+        {
+          size_t previous = 0;
+          size_t evens = 0;
+          bool first = true;
+          list.for_each(
+              [&](size_t key, size_t value)
+              {
+                if (!first && key <= previous) inconsistencies++;
+                if (value != key * 3) inconsistencies++;
+                evens += key % 2 == 0;
+                previous = key;
+                first = false;
+              });
+          if (evens != keys_count / 2) inconsistencies++;
+        }
+      });
+  for (auto &thread : threads) thread.join();
+
+  REQUIRE(inconsistencies == 0);
+  REQUIRE(list.size() == keys_count / 2);
+}
+
+TEST_CASE("Ordered map throughput across threads",
+          "[benchmark][ConcurrentSkipList]")
+{
+  const size_t keys_count = 1 << 16;
+  const size_t operations_per_thread = 1 << 16;
+  const size_t max_threads =
+      std::max(1u, std::thread::hardware_concurrency());
+
+  // Runs `operations_per_thread` operations on every thread, in which
+  // `read_percentage`% are `get`s and the rest are, evenly, `insert`s and
+  // `remove`s.
+  const auto run = [&](size_t threads_count, size_t read_percentage,
+                       auto &&get, auto &&insert, auto &&remove)
+  {
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threads_count; t++)
+    {
+      threads.emplace_back(
+          [&, t]
+          {
+            size_t state = t + 1;
+            for (size_t i = 0; i < operations_per_thread; i++)
+            {
+              state = state * 6364136223846793005ull + 1442695040888963407ull;
+              const auto key = (state >> 33) % keys_count;
+              const auto operation = (state >> 20) % 100;
+              if (operation < read_percentage) get(key);
+              else if (operation % 2 == 0) insert(key, i);
+              else remove(key);
+            }
+          });
+    }
+    for (auto &thread : threads) thread.join();
+  };
+
+  for (const size_t read_percentage : {50, 90, 99})
+  {
+    for (size_t threads_count = 1; threads_count <= max_threads;
+         threads_count *= 2)
+    {
+      const auto label = std::to_string(threads_count) + " threads, " +
+                         std::to_string(read_percentage) + "% reads";
+
+      auto list = core::trees::ConcurrentSkipList<size_t, size_t>();
+      auto tree = core::trees::BinarySearchTree<size_t, size_t>();
+      auto map = std::map<size_t, size_t>();
+      auto mutex = std::mutex();
+
+      for (size_t key = 0; key < keys_count; key += 2)
+      {
+        list.insert(key, key);
+        tree.insert(key, key);
+        map.insert_or_assign(key, key);
+      }
+
+      BENCHMARK("ConcurrentSkipList, " + label)
+      {
+        run(
+            threads_count, read_percentage,
+            [&](size_t key) { return list.get(key); },
+            [&](size_t key, size_t value) { list.insert(key, value); },
+            [&](size_t key) { list.remove(key); });
+      };
+
+      BENCHMARK("mutex-wrapped BinarySearchTree, " + label)
+      {
+        run(
+            threads_count, read_percentage,
+            [&](size_t key)
+            {
+              const std::lock_guard lock(mutex);
+              return tree.get(key) != nullptr;
+            },
+            [&](size_t key, size_t value)
+            {
+              const std::lock_guard lock(mutex);
+              tree.insert(key, value);
+            },
+            [&](size_t key)
+            {
+              const std::lock_guard lock(mutex);
+              tree.remove(key);
+            });
+      };
+
+      BENCHMARK("mutex-wrapped std::map, " + label)
+      {
+        run(
+            threads_count, read_percentage,
+            [&](size_t key)
+            {
+              const std::lock_guard lock(mutex);
+              return map.find(key) != map.end();
+            },
+            [&](size_t key, size_t value)
+            {
+              const std::lock_guard lock(mutex);
+              map.insert_or_assign(key, value);
+            },
+            [&](size_t key)
+            {
+              const std::lock_guard lock(mutex);
+              map.erase(key);
+            });
+      };
+    }
+  }
+}
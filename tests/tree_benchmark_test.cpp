@@ -0,0 +1,369 @@
+#include "benchmark_suite.hpp"
+#include "catch2/catch_all.hpp"
+#include "trees.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * A suite comparing `BinarySearchTree` and `BPlusTree` with `std::map` and
+ * `std::set` across sizes and key distributions. It's hidden from the
+ * default run, since it takes minutes:
+ *
+ *   estrutura-de-dados-test "[tree_suite]"
+ *
+ * Trees span from 1K keys up to `TREE_BENCHMARK_MAX_KEYS` (1M by default,
+ * 100M at most), skipping sizes that could take more than half the physical
+ * memory. The results are written as JSON to `TREE_BENCHMARK_OUTPUT`, or to
+ * the standard output if it's unset.
+ */
+
+namespace
+{
+
+using namespace suite;
+
+/// How many keys each range scan visits.
+constexpr size_t scan_length = 100;
+
+/**
+ * The bounds of range scans over `workload`'s keys, each starting at a key
+ * looked up and ending `scan_length` keys after it.
+ */
+std::vector<std::pair<uint64_t, uint64_t>> ranges_of(const Workload &workload)
+{
+  auto sorted = workload.keys;
+  std::ranges::sort(sorted);
+
+  const auto scans = std::max<size_t>(sorted.size() / scan_length, 1);
+  std::vector<std::pair<uint64_t, uint64_t>> ranges;
+  for (size_t i = 0; i < scans && i < workload.lookups.size(); i++)
+  {
+    const auto low = std::ranges::lower_bound(sorted, workload.lookups[i]);
+    const auto rank = (size_t)(low - sorted.begin());
+    const auto high = rank + scan_length < sorted.size()
+                          ? sorted[rank + scan_length]
+                          : UINT64_MAX;
+    ranges.emplace_back(*low, high);
+  }
+  return ranges;
+}
+
+/**
+ * Runs every operation of the suite over a fresh tree, whose interface is
+ * that of the adapters below. Traversals and range scans are timed per key
+ * visited. Memory is measured both as the bytes the tree allocated, and as
+ * how much the resident set grew with the keys, allocator overhead included.
+ */
+template <typename Tree>
+Result measure(const std::string &tree_name, Distribution distribution,
+               const Workload &workload,
+               const std::vector<std::pair<uint64_t, uint64_t>> &ranges)
+{
+  const auto count = workload.keys.size();
+  auto result = Result();
+  result.set("tree", tree_name)
+      .set("keys", count)
+      .set("distribution", name_of(distribution));
+
+  core::utils::reset_peak_rss();
+  const auto baseline_rss = core::utils::current_rss();
+
+  {
+    auto tree = Tree();
+    size_t found = 0;
+
+    const auto insert_ns = nanoseconds_per_operation(
+        count,
+        [&]
+        {
+          for (size_t i = 0; i < count; i++) tree.insert(workload.keys[i], i);
+        });
+
+    const auto bytes_per_key = (double)tree.memory_usage() / (double)count;
+    const auto rss = std::max(core::utils::current_rss(), baseline_rss);
+    const auto rss_bytes_per_key =
+        (double)(rss - baseline_rss) / (double)count;
+
+    const auto get_hit_ns = nanoseconds_per_operation(
+        count,
+        [&]
+        {
+          for (const auto key : workload.lookups) found += tree.contains(key);
+        });
+
+    const auto get_miss_ns = nanoseconds_per_operation(
+        count,
+        [&]
+        {
+          for (const auto key : workload.absent_keys)
+          {
+            found += tree.contains(key);
+          }
+        });
+
+    size_t visited = 0;
+    const auto traversal_ns = nanoseconds_per_operation(
+        count, [&] { visited += tree.traverse(); });
+
+    size_t scanned = 0;
+    const auto start = Clock::now();
+    for (const auto &[low, high] : ranges) scanned += tree.scan(low, high);
+    const auto elapsed = Clock::now() - start;
+    const auto range_scan_ns =
+        (double)std::chrono::nanoseconds(elapsed).count() /
+        (double)std::max<size_t>(scanned, 1);
+
+    const auto erase_ns = nanoseconds_per_operation(
+        count,
+        [&]
+        {
+          for (const auto key : workload.keys) tree.remove(key);
+        });
+
+    // keeps the lookups and traversals from being optimized away.
+    REQUIRE(found >= count);
+    REQUIRE(visited == count);
+
+    result.set("insert_ns", insert_ns)
+        .set("get_hit_ns", get_hit_ns)
+        .set("get_miss_ns", get_miss_ns)
+        .set("traversal_ns", traversal_ns)
+        .set("range_scan_ns", range_scan_ns)
+        .set("erase_ns", erase_ns)
+        .set("bytes_per_key", bytes_per_key)
+        .set("rss_bytes_per_key", rss_bytes_per_key);
+  }
+
+  return result;
+}
+
+/// Sums the keys visited, so that visiting them can't be skipped.
+struct Visitor
+{
+  size_t visited = 0;
+  uint64_t sum = 0;
+
+  void operator()(const uint64_t &key, const uint64_t &)
+  {
+    this->visited++;
+    this->sum += key;
+  }
+};
+
+class BinarySearchTree
+{
+private:
+  core::trees::BinarySearchTree<uint64_t, uint64_t> tree;
+
+public:
+  size_t memory_usage() const { return this->tree.memory_usage(); }
+  void insert(uint64_t key, uint64_t value) { this->tree.insert(key, value); }
+  bool contains(uint64_t key) const { return this->tree.get(key) != nullptr; }
+  void remove(uint64_t key) { this->tree.remove(key); }
+
+  size_t traverse() const
+  {
+    auto visitor = Visitor();
+    this->tree.for_each(visitor);
+    return visitor.visited;
+  }
+
+  size_t scan(uint64_t low, uint64_t high) const
+  {
+    auto visitor = Visitor();
+    this->tree.for_each_in_range(low, high, visitor);
+    return visitor.visited;
+  }
+};
+
+class BPlusTree
+{
+private:
+  core::trees::BPlusTree<uint64_t, uint64_t> tree;
+
+public:
+  size_t memory_usage() const { return this->tree.memory_usage(); }
+  void insert(uint64_t key, uint64_t value) { this->tree.insert(key, value); }
+  bool contains(uint64_t key) const { return this->tree.get(key) != nullptr; }
+  void remove(uint64_t key) { this->tree.remove(key); }
+
+  size_t traverse() const
+  {
+    auto visitor = Visitor();
+    for (auto it = this->tree.begin(); it != this->tree.end(); it++)
+    {
+      visitor(it.key(), it.value());
+    }
+    return visitor.visited;
+  }
+
+  size_t scan(uint64_t low, uint64_t high) const
+  {
+    auto visitor = Visitor();
+    for (auto it = this->tree.lower_bound(low);
+         it != this->tree.end() && it.key() < high; it++)
+    {
+      visitor(it.key(), it.value());
+    }
+    return visitor.visited;
+  }
+};
+
+/**
+ * Counts the bytes a standard container allocates, into `*bytes`.
+ */
+template <typename T> struct CountingAllocator
+{
+  using value_type = T;
+
+  size_t *bytes;
+
+  CountingAllocator(size_t *bytes) : bytes(bytes) {}
+
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U> &other) : bytes(other.bytes)
+  {
+  }
+
+  T *allocate(size_t count)
+  {
+    *this->bytes += count * sizeof(T);
+    return std::allocator<T>().allocate(count);
+  }
+
+  void deallocate(T *pointer, size_t count)
+  {
+    *this->bytes -= count * sizeof(T);
+    std::allocator<T>().deallocate(pointer, count);
+  }
+
+  template <typename U> bool operator==(const CountingAllocator<U> &) const
+  {
+    return true;
+  }
+};
+
+class Map
+{
+private:
+  using Pair = std::pair<const uint64_t, uint64_t>;
+
+  std::unique_ptr<size_t> bytes = std::make_unique<size_t>(0);
+  std::map<uint64_t, uint64_t, std::less<>, CountingAllocator<Pair>> map{
+      CountingAllocator<Pair>(this->bytes.get())};
+
+public:
+  size_t memory_usage() const { return *this->bytes; }
+
+  void insert(uint64_t key, uint64_t value)
+  {
+    this->map.insert_or_assign(key, value);
+  }
+
+  bool contains(uint64_t key) const { return this->map.contains(key); }
+  void remove(uint64_t key) { this->map.erase(key); }
+
+  size_t traverse() const
+  {
+    auto visitor = Visitor();
+    for (const auto &[key, value] : this->map) visitor(key, value);
+    return visitor.visited;
+  }
+
+  size_t scan(uint64_t low, uint64_t high) const
+  {
+    auto visitor = Visitor();
+    for (auto it = this->map.lower_bound(low);
+         it != this->map.end() && it->first < high; it++)
+    {
+      visitor(it->first, it->second);
+    }
+    return visitor.visited;
+  }
+};
+
+/**
+ * Keeps keys only, as the lower bound of what a node-based tree can take.
+ */
+class Set
+{
+private:
+  std::unique_ptr<size_t> bytes = std::make_unique<size_t>(0);
+  std::set<uint64_t, std::less<>, CountingAllocator<uint64_t>> set{
+      CountingAllocator<uint64_t>(this->bytes.get())};
+
+public:
+  size_t memory_usage() const { return *this->bytes; }
+
+  void insert(uint64_t key, uint64_t) { this->set.insert(key); }
+  bool contains(uint64_t key) const { return this->set.contains(key); }
+  void remove(uint64_t key) { this->set.erase(key); }
+
+  size_t traverse() const
+  {
+    auto visitor = Visitor();
+    for (const auto key : this->set) visitor(key, key);
+    return visitor.visited;
+  }
+
+  size_t scan(uint64_t low, uint64_t high) const
+  {
+    auto visitor = Visitor();
+    for (auto it = this->set.lower_bound(low);
+         it != this->set.end() && *it < high; it++)
+    {
+      visitor(*it, *it);
+    }
+    return visitor.visited;
+  }
+};
+
+size_t max_keys()
+{
+  const auto max_keys = limit_from_environment("TREE_BENCHMARK_MAX_KEYS",
+                                               1'000'000, 100'000'000);
+
+  // a `std::map` node takes about 64 bytes, and the workload 40 per key.
+  return std::min(max_keys, physical_memory() / 2 / 104);
+}
+
+} // namespace
+
+TEST_CASE("Ordered maps across sizes and distributions",
+          "[.][benchmark][tree_suite]")
+{
+  const size_t sizes[] = {1'000,     10'000,     100'000,
+                          1'000'000, 10'000'000, 100'000'000};
+
+  std::vector<Result> results;
+
+  for (const auto count : sizes)
+  {
+    if (count > max_keys()) break;
+
+    for (const auto distribution : distributions)
+    {
+      // misses fall between keys, rather than past the greatest one.
+      const auto workload = Workload(count, distribution, true);
+      const auto ranges = ranges_of(workload);
+
+      results.push_back(measure<BinarySearchTree>(
+          "BinarySearchTree", distribution, workload, ranges));
+      results.push_back(
+          measure<BPlusTree>("BPlusTree", distribution, workload, ranges));
+      results.push_back(
+          measure<Map>("std::map", distribution, workload, ranges));
+      results.push_back(
+          measure<Set>("std::set", distribution, workload, ranges));
+    }
+  }
+
+  write_json(results, "TREE_BENCHMARK_OUTPUT");
+}